@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "BenchInstance.hpp"
+#include "InstanceGenerator.hpp"
+
+namespace {
+    constexpr unsigned seed = 42;
+
+    const std::filesystem::path gridFile{CMAPD_BENCH_DATA_DIR "/grid.txt"};
+
+    // computed at every run, a cached matrix could belong to an older grid
+    AmbientMap buildBenchMap(){
+        const auto grid = generator::loadGrid(gridFile);
+        auto distances = std::make_shared<const std::vector<double>>(generator::distanceMatrix(grid));
+        return {
+            grid,
+            DistanceMatrix{
+                std::shared_ptr<const double>{distances, distances->data()},
+                static_cast<int>(grid.size()),
+                static_cast<int>(grid.front().size())
+            }
+        };
+    }
+
+    // AmbientMap does not keep endpoints, cell types are read from the grid file
+    std::vector<CompressedCoord> cellsOfType(const AmbientMap &ambientMap, CellType type){
+        static const auto grid = generator::loadGrid(gridFile);
+        std::vector<CompressedCoord> cells;
+        for(int r = 0 ; r < grid.size() ; ++r){
+            for(int c = 0 ; c < grid[r].size() ; ++c){
+                if(grid[r][c] == static_cast<char>(type)){
+                    cells.push_back(ambientMap.getDistanceMatrix().from2Dto1D(r, c));
+                }
+            }
+        }
+        return cells;
+    }
+}
+
+AmbientMap loadBenchMap() {
+    // copies share the distance matrix
+    static const auto ambientMap = buildBenchMap();
+    return ambientMap;
+}
+
+std::vector<AgentInfo> randomAgents(const AmbientMap &ambientMap, int nAgents, int capacity) {
+    auto cells = cellsOfType(ambientMap, CellType::FLOOR);
+    std::mt19937 gen{seed};
+    std::shuffle(cells.begin(), cells.end(), gen);
+    cells.resize(std::min<std::size_t>(nAgents, cells.size()));
+
+    std::vector<AgentInfo> agents;
+    agents.reserve(cells.size());
+    for(auto cell : cells){
+        agents.push_back({cell, capacity, static_cast<int>(agents.size())});
+    }
+    return agents;
+}
+
+std::vector<Task> randomTasks(const AmbientMap &ambientMap, int nTasks) {
+    auto endpoints = cellsOfType(ambientMap, CellType::ENDPOINT);
+    if(2 * nTasks > endpoints.size()){
+        throw std::invalid_argument("Not enough endpoints for " + std::to_string(nTasks) + " tasks");
+    }
+    std::mt19937 gen{seed};
+    std::shuffle(endpoints.begin(), endpoints.end(), gen);
+
+    std::vector<Task> tasks;
+    tasks.reserve(nTasks);
+    for(int i = 0 ; i < nTasks ; ++i){
+        tasks.emplace_back(endpoints[2 * i], endpoints[2 * i + 1], 0, i, ambientMap.getDistanceMatrix());
+    }
+    return tasks;
+}
@@ -0,0 +1,20 @@
+#ifndef SIMULTANEOUS_CMAPD_BENCHINSTANCE_HPP
+#define SIMULTANEOUS_CMAPD_BENCHINSTANCE_HPP
+
+#include <vector>
+#include "AmbientMap.hpp"
+#include "AgentInfo.hpp"
+#include "Task.hpp"
+
+// instances of the benchmarks, all built on data/grid.txt with a fixed seed
+
+// the distance matrix is computed (BFS, see generator::distanceMatrix) once per process, at the first call
+AmbientMap loadBenchMap();
+
+// agents on distinct floor cells
+std::vector<AgentInfo> randomAgents(const AmbientMap &ambientMap, int nAgents, int capacity = 3);
+
+// every endpoint is used by a single task (well formed instance), agents parked at the end of their plan block no task
+std::vector<Task> randomTasks(const AmbientMap &ambientMap, int nTasks);
+
+#endif //SIMULTANEOUS_CMAPD_BENCHINSTANCE_HPP
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+#include <boost/heap/fibonacci_heap.hpp>
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include "IndexedHeap.hpp"
+
+// compares the old node based heaps (handles in hash maps, type erased comparator) with IndexedHeap
+
+namespace {
+    struct Item{
+        int id;
+        int key;
+    };
+
+    struct ItemGreater{
+        bool operator()(const Item &a, const Item &b) const { return a.key > b.key; }
+    };
+
+    using FibHeap = boost::heap::fibonacci_heap<Item, boost::heap::compare<std::function<bool(const Item&, const Item&)>>>;
+    using FlatHeap = IndexedHeap<Item, ItemGreater>;
+
+    // (id, new key) pairs, precomputed to keep random generation out of the measure
+    std::vector<std::pair<int, int>> buildUpdates(int n){
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> idDist{0, n - 1};
+        std::uniform_int_distribution<int> keyDist{0, 1000};
+
+        std::vector<std::pair<int, int>> updates(4096);
+        for(auto& u : updates){
+            u = {idDist(gen), keyDist(gen)};
+        }
+        return updates;
+    }
+
+    int initialKey(int id){
+        return (id * 7919) % 1000;
+    }
+}
+
+static void BM_FibonacciHeapUpdate(benchmark::State &state){
+    const auto n = static_cast<int>(state.range(0));
+    const auto updates = buildUpdates(n);
+
+    FibHeap heap{ItemGreater{}};
+    std::unordered_map<int, FibHeap::handle_type> handles;
+    for(int i = 0 ; i < n ; ++i){
+        handles.emplace(i, heap.push({i, initialKey(i)}));
+    }
+
+    std::size_t u = 0;
+    for(auto _ : state){
+        const auto& [id, key] = updates[u++ % updates.size()];
+        auto& handle = handles[id];
+        (*handle).key = key;
+        heap.update(handle);
+        benchmark::DoNotOptimize(heap.top());
+    }
+}
+
+static void BM_IndexedHeapUpdate(benchmark::State &state){
+    const auto n = static_cast<int>(state.range(0));
+    const auto updates = buildUpdates(n);
+
+    FlatHeap heap{};
+    for(int i = 0 ; i < n ; ++i){
+        heap.emplace(i, Item{i, initialKey(i)});
+    }
+
+    std::size_t u = 0;
+    for(auto _ : state){
+        const auto& [id, key] = updates[u++ % updates.size()];
+        heap[id].key = key;
+        heap.update(id);
+        benchmark::DoNotOptimize(heap.top());
+    }
+}
+
+static void BM_FibonacciHeapBuildAndDrain(benchmark::State &state){
+    const auto n = static_cast<int>(state.range(0));
+
+    for(auto _ : state){
+        FibHeap heap{ItemGreater{}};
+        std::unordered_map<int, FibHeap::handle_type> handles;
+        for(int i = 0 ; i < n ; ++i){
+            handles.emplace(i, heap.push({i, initialKey(i)}));
+        }
+        while(!heap.empty()){
+            handles.erase(heap.top().id);
+            heap.pop();
+        }
+        benchmark::DoNotOptimize(handles.size());
+    }
+}
+
+static void BM_IndexedHeapBuildAndDrain(benchmark::State &state){
+    const auto n = static_cast<int>(state.range(0));
+
+    for(auto _ : state){
+        FlatHeap heap{};
+        for(int i = 0 ; i < n ; ++i){
+            heap.emplace(i, Item{i, initialKey(i)});
+        }
+        while(!heap.empty()){
+            heap.pop();
+        }
+        benchmark::DoNotOptimize(heap.size());
+    }
+}
+
+BENCHMARK(BM_FibonacciHeapUpdate)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_IndexedHeapUpdate)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_FibonacciHeapBuildAndDrain)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_IndexedHeapBuildAndDrain)->RangeMultiplier(8)->Range(64, 32768);
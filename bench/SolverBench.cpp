@@ -0,0 +1,287 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <stdexcept>
+#include "BenchInstance.hpp"
+#include "Assignment.hpp"
+#include "BigH.hpp"
+#include "SCMAPD.hpp"
+#include "SmallH.hpp"
+#include "Status.hpp"
+#include "ThreadPool.hpp"
+#include "MAPF/MultiAStar.hpp"
+
+// hot kernels of the solver and end to end solve, on instances of BenchInstance
+
+namespace {
+    // agents and tasks of the kernel benchmarks, the plans are dense enough to produce conflicts
+    constexpr int nAgents = 10;
+    constexpr int nTasks = 60;
+    // the first ones are in the plans, the others are available for the benchmarks
+    constexpr int nPlannedTasks = 20;
+
+    // every agent planned through its share of the tasks, one after the other as the greedy would fix them
+    const Status &plannedStatus(){
+        static const Status status = [](){
+            auto ambientMap = loadBenchMap();
+            auto agents = randomAgents(ambientMap, nAgents);
+            auto tasks = randomTasks(ambientMap, nTasks);
+            Status s{std::move(ambientMap), nAgents, std::move(tasks)};
+
+            for(const auto& agent : agents){
+                WaypointsList waypoints;
+                std::vector<int> taskIds;
+                for(int taskId = agent.index ; taskId < nPlannedTasks ; taskId += nAgents){
+                    waypoints.push_back(getTaskPickupWaypoint(s.getTask(taskId)));
+                    waypoints.push_back(getTaskDeliveryWaypoint(s.getTask(taskId)));
+                    taskIds.push_back(taskId);
+                }
+                if(waypoints.empty()){
+                    continue;
+                }
+                // agents parked by earlier plans can make the plan infeasible, such agents stay idle
+                try{
+                    MultiAStar pathfinder{};
+                    auto [path, plannedWaypoints] = pathfinder.solve(std::move(waypoints), agent.startPos, s, agent.index);
+                    s.updatePaths(std::move(path), std::move(plannedWaypoints), agent.index);
+                    s.setAssignedTasks(agent.index, std::move(taskIds));
+                }
+                catch(const std::runtime_error&){
+                    continue;
+                }
+            }
+            return s;
+        }();
+        return status;
+    }
+
+    const std::vector<AgentInfo> &benchAgents(){
+        static const auto agents = randomAgents(loadBenchMap(), nAgents);
+        return agents;
+    }
+
+    // tasks not in the planned status, without the ones that some agent cannot plan (e.g. ending where another agent
+    // parks)
+    const std::vector<int> &freeTaskIds(){
+        static const auto taskIds = [](){
+            std::vector<int> ids;
+            for(int taskId = nPlannedTasks ; taskId < nTasks ; ++taskId){
+                try{
+                    SmallH smallH{benchAgents(), taskId, plannedStatus(), false};
+                    ids.push_back(taskId);
+                }
+                catch(const std::runtime_error&){
+                    continue;
+                }
+            }
+            return ids;
+        }();
+        return taskIds;
+    }
+
+    // first n free tasks, n is capped to the available ones
+    std::vector<int> firstFreeTasks(int n){
+        const auto& taskIds = freeTaskIds();
+        return {taskIds.begin(), taskIds.begin() + std::min<std::size_t>(n, taskIds.size())};
+    }
+
+    std::vector<CompressedCoord> freeCells(const AmbientMap &ambientMap){
+        const auto& dm = ambientMap.getDistanceMatrix();
+        std::vector<CompressedCoord> cells;
+        for(CompressedCoord c = 0 ; c < dm.startCoordsSize ; ++c){
+            if(ambientMap.isValid(dm.from1Dto2D(c))){
+                cells.push_back(c);
+            }
+        }
+        return cells;
+    }
+}
+
+static void BM_DistanceMatrixGetDistance(benchmark::State &state){
+    const auto ambientMap = loadBenchMap();
+    const auto& dm = ambientMap.getDistanceMatrix();
+    const auto cells = freeCells(ambientMap);
+
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<std::size_t> cellDist{0, cells.size() - 1};
+    std::vector<std::pair<CompressedCoord, CompressedCoord>> queries(4096);
+    for(auto& q : queries){
+        q = {cells[cellDist(gen)], cells[cellDist(gen)]};
+    }
+
+    std::size_t i = 0;
+    for(auto _ : state){
+        const auto& [from, to] = queries[i++ % queries.size()];
+        benchmark::DoNotOptimize(dm.getDistance(from, to));
+    }
+}
+
+static void BM_AmbientMapMovement(benchmark::State &state){
+    const auto ambientMap = loadBenchMap();
+    const auto cells = freeCells(ambientMap);
+
+    std::size_t i = 0;
+    for(auto _ : state){
+        auto cell = cells[i % cells.size()];
+        benchmark::DoNotOptimize(ambientMap.movement(cell, static_cast<int>(i % AmbientMap::nDirections)));
+        ++i;
+    }
+}
+
+static void BM_StatusGetValidNeighbors(benchmark::State &state){
+    const auto& status = plannedStatus();
+    const auto cells = freeCells(loadBenchMap());
+
+    TimeStep horizon = 1;
+    for(const auto& path : status.getPaths()){
+        horizon = std::max(horizon, static_cast<TimeStep>(path.size()));
+    }
+
+    std::size_t i = 0;
+    for(auto _ : state){
+        auto cell = cells[i % cells.size()];
+        benchmark::DoNotOptimize(status.getValidNeighbors(0, cell, static_cast<TimeStep>(i % horizon)));
+        ++i;
+    }
+}
+
+static void BM_StatusCheckPathConflicts(benchmark::State &state){
+    const auto& paths = plannedStatus().getPaths();
+
+    std::vector<std::pair<int, int>> pairs;
+    for(int a = 0 ; a < paths.size() ; ++a){
+        for(int b = a + 1 ; b < paths.size() ; ++b){
+            if(!paths[a].empty() && !paths[b].empty()){
+                pairs.emplace_back(a, b);
+            }
+        }
+    }
+
+    std::size_t i = 0;
+    for(auto _ : state){
+        const auto& [a, b] = pairs[i++ % pairs.size()];
+        benchmark::DoNotOptimize(Status::checkPathConflicts(paths[a], paths[b]));
+    }
+}
+
+// plan of range(0) tasks for an agent, avoiding the planned ones
+static void BM_MultiAStarSolve(benchmark::State &state){
+    const auto& status = plannedStatus();
+    const auto& agent = benchAgents().front();
+
+    WaypointsList waypoints;
+    for(auto taskId : firstFreeTasks(static_cast<int>(state.range(0)))){
+        waypoints.push_back(getTaskPickupWaypoint(status.getTask(taskId)));
+        waypoints.push_back(getTaskDeliveryWaypoint(status.getTask(taskId)));
+    }
+
+    for(auto _ : state){
+        MultiAStar pathfinder{};
+        benchmark::DoNotOptimize(pathfinder.solve(WaypointsList{waypoints}, agent.startPos, status, agent.index));
+    }
+}
+
+// insertTaskWaypoints is private, it is measured through addTask (best insertion followed by the path planning)
+static void BM_AssignmentAddTask(benchmark::State &state){
+    const auto& status = plannedStatus();
+    const auto& agent = benchAgents().front();
+
+    auto taskIds = firstFreeTasks(static_cast<int>(state.range(0)) + 1);
+    auto newTaskId = taskIds.back();
+    taskIds.pop_back();
+
+    Assignment assignment{agent};
+    for(auto taskId : taskIds){
+        assignment.addTask(taskId, status);
+    }
+
+    for(auto _ : state){
+        state.PauseTiming();
+        Assignment candidate{assignment};
+        state.ResumeTiming();
+
+        candidate.addTask(newTaskId, status);
+        benchmark::DoNotOptimize(candidate.getMCA());
+    }
+}
+
+// one entry per agent
+static void BM_SmallHBuild(benchmark::State &state){
+    const auto& status = plannedStatus();
+    const auto& agents = benchAgents();
+
+    for(auto _ : state){
+        SmallH smallH{agents, freeTaskIds().front(), status, false};
+        benchmark::DoNotOptimize(smallH.getTopMCA());
+    }
+}
+
+// heap of range(0) tasks
+static void BM_BigHBuild(benchmark::State &state){
+    const auto& status = plannedStatus();
+    const auto& agents = benchAgents();
+    ThreadPool pool{1};
+
+    const auto taskIds = firstFreeTasks(static_cast<int>(state.range(0)));
+    state.counters["tasks"] = static_cast<double>(taskIds.size());
+
+    for(auto _ : state){
+        BigH<heuristics::MCA> bigH{agents, status, taskIds, false, false, pool};
+        benchmark::DoNotOptimize(bigH.empty());
+    }
+}
+
+// one iteration of the greedy loop: extraction of the best task and update of the heap
+static void BM_BigHExtractAndUpdate(benchmark::State &state){
+    const auto& agents = benchAgents();
+    ThreadPool pool{1};
+
+    const auto taskIds = firstFreeTasks(static_cast<int>(state.range(0)));
+    state.counters["tasks"] = static_cast<double>(taskIds.size());
+
+    for(auto _ : state){
+        state.PauseTiming();
+        auto status = plannedStatus();
+        BigH<heuristics::MCA> bigH{agents, status, taskIds, false, false, pool};
+        state.ResumeTiming();
+
+        auto [taskId, pathWrapper] = bigH.extractTop(status);
+        auto k = pathWrapper.agentId;
+        status.updatePaths(std::move(pathWrapper.path), std::move(pathWrapper.waypoints), k);
+        status.assignTask(taskId, k);
+        bigH.update(k, taskId, status);
+    }
+}
+
+// construction (heap of all tasks) and greedy insertion, range(0) agents and range(1) tasks
+static void BM_SCMAPDSolve(benchmark::State &state){
+    SolverOptions options{.nThreads = 1};
+
+    for(auto _ : state){
+        state.PauseTiming();
+        auto ambientMap = loadBenchMap();
+        auto agents = randomAgents(ambientMap, static_cast<int>(state.range(0)));
+        auto tasks = randomTasks(ambientMap, static_cast<int>(state.range(1)));
+        state.ResumeTiming();
+
+        try{
+            SCMAPD scmapd{std::move(ambientMap), agents, std::move(tasks), options, false};
+            scmapd.solve(std::chrono::minutes{1});
+            benchmark::DoNotOptimize(scmapd.getTotalDelay());
+        }
+        catch(const std::runtime_error &e){
+            state.SkipWithError(e.what());
+            break;
+        }
+    }
+}
+
+BENCHMARK(BM_DistanceMatrixGetDistance);
+BENCHMARK(BM_AmbientMapMovement);
+BENCHMARK(BM_StatusGetValidNeighbors);
+BENCHMARK(BM_StatusCheckPathConflicts);
+BENCHMARK(BM_MultiAStarSolve)->DenseRange(1, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AssignmentAddTask)->Arg(0)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SmallHBuild)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BigHBuild)->RangeMultiplier(2)->Range(4, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BigHExtractAndUpdate)->RangeMultiplier(2)->Range(4, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SCMAPDSolve)->Args({5, 20})->Args({10, 40})->Args({20, 80})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+# Compare insertion heuristics on solve time and total delay.
+# usage: compare_heuristics.sh <cmapd> <map> <distance matrix> <agents> <tasks> [<agents> <tasks> ...] [-- extra cmapd args]
+
+set -euo pipefail
+
+if [ "$#" -lt 5 ]; then
+    echo "usage: $0 <cmapd> <map> <distance matrix> <agents> <tasks> [<agents> <tasks> ...] [-- extra cmapd args]" >&2
+    exit 1
+fi
+
+cmapd=$1
+map=$2
+dm=$3
+shift 3
+
+instances=()
+while [ "$#" -gt 0 ] && [ "$1" != "--" ]; do
+    instances+=("$1")
+    shift
+done
+[ "$#" -gt 0 ] && shift
+extra=("$@")
+
+printf "%-30s %-8s %10s %12s\n" "instance" "heur" "time [s]" "total delay"
+for ((i = 0 ; i < ${#instances[@]} ; i += 2)); do
+    agents=${instances[i]}
+    tasks=${instances[i+1]}
+
+    for heuristic in MCA RMCA_A RMCA_R; do
+        start=$(date +%s.%N)
+        delay=$("$cmapd" --m "$map" --dm "$dm" --a "$agents" --t "$tasks" --heuristic "$heuristic" "${extra[@]}" \
+            | sed -n 's/.*Total delay: //p')
+        end=$(date +%s.%N)
+
+        printf "%-30s %-8s %10.3f %12s\n" "$(basename "$tasks")" "$heuristic" "$(awk -v s="$start" -v e="$end" 'BEGIN{print e - s}')" "$delay"
+    done
+done
@@ -8,6 +8,8 @@
 #include <filesystem>
 #include <array>
 #include <optional>
+#include <string>
+#include <vector>
 #include "TypeDefs.hpp"
 #include "Coord.hpp"
 #include "DistanceMatrix.hpp"
@@ -26,6 +28,9 @@ public:
 
     AmbientMap(const std::filesystem::path &gridPath, DistanceMatrix&& dm);
 
+    // rows are the lines of a grid file, all of the same length
+    AmbientMap(const std::vector<std::string> &rows, DistanceMatrix&& dm);
+
     [[nodiscard]] bool isValid(const Coord &coord) const;
     CellType operator[](const Coord& coord) const;
 
@@ -41,8 +46,8 @@ private:
     const DistanceMatrix distanceMatrix;
     std::vector<std::vector<CellType>> grid;
 
-    static std::vector<std::vector<CellType>> getGrid(std::fstream &&data);
-    static std::fstream openGridFile(const std::filesystem::path &gridPath);
+    static std::vector<std::vector<CellType>> getGrid(const std::vector<std::string> &rows);
+    static std::vector<std::string> readGridFile(const std::filesystem::path &gridPath);
 
 };
 
@@ -11,10 +11,25 @@
 #include "Waypoint.hpp"
 #include "Status.hpp"
 #include "AgentInfo.hpp"
+#include "CompactPath.hpp"
 
 struct PathWrapper{
     int agentId;
     Path path;
+    // sum of the delays of the agent tasks
+    TimeStep ttd = 0;
+    WaypointsList waypoints{};
+};
+
+struct AssignmentMemory{
+    // heap arrays holding the assignments (and the SmallH objects in BigH)
+    std::size_t entries = 0;
+    std::size_t waypoints = 0;
+    std::size_t storedPath = 0;
+    // bytes the path would use if stored uncompressed
+    std::size_t fullPath = 0;
+
+    AssignmentMemory &operator+=(const AssignmentMemory &other);
 };
 
 /**
@@ -25,12 +40,18 @@ class Assignment {
 
 public:
     /**
-     *
-     * @param startPosition initial position of the agent
-     * @param index numerical id for the agent
-     * @param capacity max number of tasks the agent can keep
+     * @brief assignment with no tasks, use addTask to build a plan
+     * @param agentInfo initial position, id and capacity of the agent
+     * @param compact store path as CompactPath, full path is materialized only when extracted
      */
-    explicit Assignment(const AgentInfo &agentInfo, int firstTaskId, const Status &status);
+    Assignment(const AgentInfo &agentInfo, bool compact = false);
+
+    /**
+     * @brief plan of the agent in status, with firstTaskId added
+     * @param agentInfo initial position, id and capacity of the agent
+     * @param compact store path as CompactPath, full path is materialized only when extracted
+     */
+    Assignment(const AgentInfo &agentInfo, int firstTaskId, const Status &status, bool compact = false);
 
     /// @return agent capacity
     [[nodiscard]] int getCapacity() const;
@@ -61,8 +82,18 @@ public:
     void
     addTask(int taskId, const Status &status);
 
+    /// @brief addTask for a task already fixed in the status plan of this agent, keeps refresh bookkeeping in sync
+    void addFixedTask(int taskId, const Status &status);
+
+    /// @warning empty in compact mode, use hasConflicts to compare it with other paths
     [[nodiscard]] const Path& getPath() const;
 
+    /// @return true if actual path is in conflict with other, see Status::checkPathConflicts for window
+    [[nodiscard]] bool hasConflicts(const Path &other, TimeStep window = 0) const;
+
+    /// @return approximated heap bytes used by path and waypoints
+    [[nodiscard]] AssignmentMemory getMemoryUsage() const;
+
     friend bool operator<(const Assignment &a, const Assignment &b);
     friend bool operator>(const Assignment &a, const Assignment &b);
 
@@ -71,17 +102,41 @@ public:
     // this should be called when waypoints and/or constraints are changed
     void internalUpdate(const Status &status);
 
+    /// @return true if path was computed (or validated) with the actual status version
+    [[nodiscard]] bool isUpToDate(const Status &status) const;
+
+    /**
+     * @brief lazy update: add the tasks fixed for this agent since last refresh and replan if path is in conflict
+     * @details while stale, MCA keeps the last computed value, which is used as a lower bound of the refreshed one
+     */
+    void refresh(const Status &status);
+
     [[nodiscard]] const WaypointsList &getWaypoints() const;
 private:
     CompressedCoord startPos;
     int index;
     int capacity;
+    // tasks already picked up at the beginning of the plan
+    int initialLoad = 0;
 
     TimeStep oldTTD = 0;
 
+    // status version of last path validation and number of agent fixed tasks included in waypoints
+    int statusVersion = 0;
+    int nSyncedTasks = 0;
+
     WaypointsList waypoints{};
     Path path{};
 
+    bool compact;
+    CompactPath compactPath{};
+
+    // store the path computed by the planner, compressing it if needed
+    void setPath(Path &&newPath, const Status &status);
+
+    // actual path, in compact mode it is decoded in a thread local buffer valid until next call
+    [[nodiscard]] const Path &getMaterializedPath() const;
+
     std::pair<WaypointsList::iterator, WaypointsList::iterator> insertNewWaypoints(const Task &task, std::_List_iterator<Waypoint> waypointStart,
                                                                                    std::_List_iterator<Waypoint> waypointGoal);
 
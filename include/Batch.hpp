@@ -0,0 +1,51 @@
+#ifndef SIMULTANEOUS_CMAPD_BATCH_HPP
+#define SIMULTANEOUS_CMAPD_BATCH_HPP
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AmbientMap.hpp"
+#include "Solver.hpp"
+
+struct BatchInstance{
+    std::filesystem::path agentsFile;
+    std::filesystem::path tasksFile;
+    std::filesystem::path resultFile;
+};
+
+struct BatchOptions{
+    // solver.nThreads is the number of threads of every instance
+    SolveOptions solve{};
+    // instances solved at the same time
+    int nJobs = 1;
+};
+
+struct BatchResult{
+    bool solved = false;
+    bool collisions = false;
+    TimeStep totalDelay = 0;
+    std::chrono::duration<double, std::milli> time{};
+    // reason of the failure, if not solved
+    std::string error{};
+};
+
+/**
+ * @brief instances of a manifest, one per line as agentsFile tasksFile [resultFile] separated by spaces or tabs
+ * @details empty lines and lines starting with # are skipped, relative paths are resolved from the manifest directory
+ * (result files from resultDir) and the default result file is resultDir/<tasks file stem>.txt
+ * @throw std::runtime_error if the manifest cannot be read, a line is malformed or two instances share a result file
+ */
+std::vector<BatchInstance> loadManifest(const std::filesystem::path &manifest, const std::filesystem::path &resultDir);
+
+/**
+ * @brief solve every instance on the same map with solveFiles, nJobs at a time, writing each result followed by the
+ * collision check and the total delay in its result file
+ * @details the map and the distance matrix are loaded once and only read by the solvers, a failing instance does not
+ * stop the others
+ * @return one result per instance, in the same order
+ */
+std::vector<BatchResult> solveBatch(const std::shared_ptr<const AmbientMap> &ambientMap,
+                                    const std::vector<BatchInstance> &instances, const BatchOptions &options);
+
+#endif //SIMULTANEOUS_CMAPD_BATCH_HPP
@@ -2,41 +2,90 @@
 #define SIMULTANEOUS_CMAPD_BIGH_HPP
 
 #include <vector>
+#include <variant>
 #include "SmallH.hpp"
+#include "ThreadPool.hpp"
+#include "Heuristics.hpp"
 
-// todo check if heap is max or min
-using SmallHComp = std::function<bool(const SmallH&,const SmallH&)>;
-using BigHFibHeap = boost::heap::fibonacci_heap<SmallH, boost::heap::compare<SmallHComp>>;
-using BigHHandles = std::unordered_map<int, BigHFibHeap::handle_type>;
+template<typename HeuristicPolicy>
+struct SmallHComp{
+    bool operator()(const SmallH &a, const SmallH &b) const{
+        return HeuristicPolicy::compare(a, b);
+    }
+};
 
 struct ExtractedPath{
     int taskId;
     PathWrapper pathWrapper;
 };
 
+struct FixedTask{
+    int agentId;
+    int taskId;
+};
+
+/**
+ * @class BigH
+ * @brief heap of the SmallH of the unassigned tasks
+ * @tparam HeuristicPolicy one of the policies in heuristics, instantiated in BigH.cpp
+ */
+template<typename HeuristicPolicy>
 class BigH {
 public:
-    BigH(const std::vector<AgentInfo> &agentInfos, const Status &status, Heuristic h);
-    ExtractedPath extractTop();
+    // indexed by task id
+    using Heap = IndexedHeap<SmallH, SmallHComp<HeuristicPolicy>>;
+
+    BigH(const std::vector<AgentInfo> &agentInfos, const Status &status, bool lazy, bool compact, ThreadPool &pool);
+    // heap of taskIds only, SmallH entries include the tasks already fixed in status
+    BigH(const std::vector<AgentInfo> &agentInfos, const Status &status, const std::vector<int> &taskIds, bool lazy,
+         bool compact, ThreadPool &pool);
+    ExtractedPath extractTop(const Status &status);
+    /**
+     * @brief cheap alternative to extractTop, used when out of time
+     * @details task and agent are chosen on the current (possibly stale) keys and only the chosen entry is replanned,
+     * afterwards the heap must not be updated anymore
+     */
+    ExtractedPath extractTopDegraded(const Status &status);
+    /**
+     * @brief extractTop followed by the next best tasks (at most maxSize in total) that can be fixed together with it
+     * @details a task joins the batch if its best agent is not used by the batch and its path is not in conflict with
+     * the paths of the batch (in lazy mode the entry must also be up to date)
+     */
+    std::vector<ExtractedPath> extractBatch(const Status &status, int maxSize);
     [[nodiscard]] bool empty() const;
+    // tasks still in the heap, sorted
+    [[nodiscard]] std::vector<int> getTaskIds() const;
 
     void update(int k, int taskId, const Status &status);
+    // single update for tasks fixed together, agents must be distinct
+    void update(const std::vector<FixedTask> &fixedTasks, const Status &status);
 
-private:
-    int v;
+    // memory used by the assignments of all SmallH
+    [[nodiscard]] AssignmentMemory getMemoryUsage() const;
 
-    BigHFibHeap heap;
-    BigHHandles heapHandles;
+private:
+    static constexpr int v = HeuristicPolicy::v;
 
-    std::unordered_set<int> unassignedTaskIndices;
+    // recompute SmallH entries only when they reach the top
+    bool lazy;
+    ThreadPool &pool;
 
-    static SmallHComp getComparator(Heuristic h);
+    Heap heap;
 
-    static BigHFibHeap
-    buildPartialAssignmentHeap(const std::vector<AgentInfo> &agentsInfos, const Status &status, int v, Heuristic h);
+    static std::vector<int> allTaskIds(const Status &status);
 
-    static BigHHandles getHandles(const BigHFibHeap& heap);
+    static Heap
+    buildPartialAssignmentHeap(const std::vector<AgentInfo> &agentsInfos, const Status &status,
+                               const std::vector<int> &taskIds, bool compact, ThreadPool &pool);
 };
 
+using AnyBigH = std::variant<BigH<heuristics::MCA>, BigH<heuristics::RMCA_A>, BigH<heuristics::RMCA_R>>;
+
+// BigH specialized on the heuristic chosen at runtime
+AnyBigH makeBigH(Heuristic h, const std::vector<AgentInfo> &agentInfos, const Status &status, bool lazy, bool compact,
+                 ThreadPool &pool);
+// same, with the heap of taskIds only
+AnyBigH makeBigH(Heuristic h, const std::vector<AgentInfo> &agentInfos, const Status &status,
+                 const std::vector<int> &taskIds, bool lazy, bool compact, ThreadPool &pool);
 
 #endif //SIMULTANEOUS_CMAPD_BIGH_HPP
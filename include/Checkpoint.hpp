@@ -0,0 +1,30 @@
+#ifndef SIMULTANEOUS_CMAPD_CHECKPOINT_HPP
+#define SIMULTANEOUS_CMAPD_CHECKPOINT_HPP
+
+#include <filesystem>
+#include <vector>
+#include "Status.hpp"
+
+/**
+ * @brief write paths, waypoints and assigned tasks of every agent, together with the tasks still to insert
+ * @details binary format (varint encoded, paths as coordinate deltas) starting with a fingerprint of the tasks and of
+ * the agent positions, the file is replaced atomically so that a preempted run always leaves a complete checkpoint.
+ * Checkpoints are saved by the greedy insertion of SCMAPD::solve before its deadline, so no step is executed, no task
+ * is degraded and no disruption or streamed task is applied yet: the plans are the whole state, the delays of the
+ * agents are recomputed from the waypoints
+ */
+void saveCheckpoint(const std::filesystem::path &file, const Status &status, const std::vector<AgentInfo> &agents,
+                    const std::vector<int> &pendingTasks);
+
+/**
+ * @brief restore in status the plans of a checkpoint saved on the same instance
+ * @details the plans are validated before touching status: paths start at the agent positions and move on free cells
+ * of the map, waypoints are visited by the paths of their agents, every task is either assigned to a single agent or
+ * pending and the paths have no conflicts
+ * @throw std::runtime_error if the file is not a checkpoint, belongs to another instance or its plans are not valid
+ * @return ids of the tasks left to insert
+ */
+std::vector<int> loadCheckpoint(const std::filesystem::path &file, const std::vector<AgentInfo> &agents,
+                                Status &status);
+
+#endif //SIMULTANEOUS_CMAPD_CHECKPOINT_HPP
@@ -0,0 +1,20 @@
+#ifndef SIMULTANEOUS_CMAPD_COMMANDLINE_HPP
+#define SIMULTANEOUS_CMAPD_COMMANDLINE_HPP
+
+#include <boost/program_options.hpp>
+#include "Solver.hpp"
+
+/**
+ * @brief solver settings shared by cmapd, cmapd_batch and cmapd_server: heuristic, batch, window, replan-every, threads,
+ * lazy and compact
+ * @param defaultThreads default of threads, the tools solving many instances at once use fewer threads for each
+ */
+boost::program_options::options_description solverOptionsDescription(int defaultThreads);
+
+/**
+ * @brief SolverOptions with the settings of solverOptionsDescription, the other fields keep their defaults
+ * @throw boost::program_options::validation_error if a setting is not valid
+ */
+SolverOptions parseSolverOptions(const boost::program_options::variables_map &vm);
+
+#endif //SIMULTANEOUS_CMAPD_COMMANDLINE_HPP
@@ -0,0 +1,42 @@
+#ifndef SIMULTANEOUS_CMAPD_COMPACTPATH_HPP
+#define SIMULTANEOUS_CMAPD_COMPACTPATH_HPP
+
+#include <vector>
+#include <cstdint>
+#include "Coord.hpp"
+
+/**
+ * @class CompactPath
+ * @brief path stored as 4 bit movement codes (about 8 times smaller than Path), decoded on demand
+ */
+class CompactPath {
+public:
+    CompactPath() = default;
+    CompactPath(const Path &path, int nCols);
+
+    /// @return the full path
+    [[nodiscard]] Path decode() const;
+
+    /// @brief same as decode but reusing out storage
+    void decode(Path &out) const;
+
+    [[nodiscard]] int size() const;
+    [[nodiscard]] bool empty() const;
+
+    /// @return heap bytes used by the encoding
+    [[nodiscard]] std::size_t getMemoryUsage() const;
+
+private:
+    // one code per nibble, codes < nMoves are AmbientMap directions, escape code is followed by 8 nibbles (raw coord)
+    static constexpr std::uint8_t escapeCode = 0xF;
+
+    CompressedCoord first = 0;
+    int length = 0;
+    int nCols = 0;
+    std::vector<std::uint8_t> codes{};
+
+    void pushCode(std::uint8_t code, int &nibbleIndex);
+    [[nodiscard]] std::uint8_t getCode(int nibbleIndex) const;
+};
+
+#endif //SIMULTANEOUS_CMAPD_COMPACTPATH_HPP
@@ -6,12 +6,20 @@
 #define SIMULTANEOUS_CMAPD_DISTANCEMATRIX_HPP
 
 #include <filesystem>
-#include <cnpy.h>
+#include <memory>
 #include "TypeDefs.hpp"
 #include "Coord.hpp"
 
 struct DistanceMatrix {
     explicit DistanceMatrix(const std::filesystem::path& data);
+
+    /**
+     * @brief distance matrix of a nRows x nCols grid on a buffer already in memory, which is shared and not copied
+     * @param distances nRows * nCols * nRows * nCols distances, the one from a to b (compressed coordinates) at
+     * a * nRows * nCols + b, in the layout of the .npy files
+     */
+    DistanceMatrix(std::shared_ptr<const double> distances, int nRows, int nCols);
+
     [[nodiscard]] int getDistance(CompressedCoord from, CompressedCoord to) const;
     [[nodiscard]] int getDistance(const Coord &from, const Coord &to) const;
 
@@ -20,12 +28,17 @@ struct DistanceMatrix {
 
     [[nodiscard]] Coord from1Dto2D(CompressedCoord point) const;
 
-    const cnpy::NpyArray rawDistanceMatrix;
+    /// @return bytes of the distances buffer
+    [[nodiscard]] std::size_t getMemoryUsage() const;
+
     const int nRows;
     const int nCols;
 
     const int startCoordsSize;
     const int endCoordsSize;
+
+private:
+    std::shared_ptr<const double> distances;
 };
 
 #endif //SIMULTANEOUS_CMAPD_DISTANCEMATRIX_HPP
@@ -0,0 +1,58 @@
+#ifndef SIMULTANEOUS_CMAPD_HEURISTICS_HPP
+#define SIMULTANEOUS_CMAPD_HEURISTICS_HPP
+
+#include "SmallH.hpp"
+
+/**
+ * insertion heuristics, used as compile time policies of BigH
+ * each policy defines:
+ * - v: number of top SmallH entries the heuristic looks at
+ * - compare(a, b): true if a has lower priority than b (boost::heap convention)
+ */
+namespace heuristics{
+    struct MCA{
+        static constexpr Heuristic id = Heuristic::MCA;
+        static constexpr int v = 1;
+
+        static bool compare(const SmallH &a, const SmallH &b){
+            return a.getTopMCA() > b.getTopMCA();
+        }
+    };
+
+    // regret: how much is lost if the task is not given to its best agent, the highest regret goes first
+    struct RMCA_A{
+        static constexpr Heuristic id = Heuristic::RMCA_A;
+        static constexpr int v = 2;
+
+        static bool compare(const SmallH &a, const SmallH &b){
+            auto aVal = a.getSecondMCA() - a.getTopMCA();
+            auto bVal = b.getSecondMCA() - b.getTopMCA();
+
+            if(aVal != bVal){
+                return aVal < bVal;
+            }
+            return MCA::compare(a, b);
+        }
+    };
+
+    // relative regret second / top, compared by cross multiplication (top MCA can be 0 or negative)
+    struct RMCA_R{
+        static constexpr Heuristic id = Heuristic::RMCA_R;
+        static constexpr int v = 2;
+
+        static bool compare(const SmallH &a, const SmallH &b){
+            auto aTop = static_cast<long long>(a.getTopMCA());
+            auto bTop = static_cast<long long>(b.getTopMCA());
+            auto aVal = a.getSecondMCA() * bTop;
+            auto bVal = b.getSecondMCA() * aTop;
+
+            if(aVal != bVal){
+                // multiplying by aTop * bTop < 0 flips the inequality, a top MCA of 0 counts as positive
+                return (aTop < 0) != (bTop < 0) ? aVal > bVal : aVal < bVal;
+            }
+            return MCA::compare(a, b);
+        }
+    };
+}
+
+#endif //SIMULTANEOUS_CMAPD_HEURISTICS_HPP
@@ -0,0 +1,236 @@
+#ifndef SIMULTANEOUS_CMAPD_INDEXEDHEAP_HPP
+#define SIMULTANEOUS_CMAPD_INDEXEDHEAP_HPP
+
+#include <vector>
+#include <optional>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+#include <boost/container/static_vector.hpp>
+#include "Profiling.hpp"
+
+/**
+ * @class IndexedHeap
+ * @brief flat D-ary heap of elements addressed by a dense integer id (agent id, task id)
+ * @details same convention of boost::heap: top is the element e such that compare(e, other) is false for every other
+ * @tparam T element type
+ * @tparam Compare comparator, fixed at compile time
+ * @tparam D arity of the heap
+ */
+template<typename T, typename Compare, int D = 4>
+class IndexedHeap {
+    static_assert(D >= 2);
+public:
+    explicit IndexedHeap(Compare compare = Compare{}) : compare{std::move(compare)} {}
+
+    /// @brief build element with id in place and push it
+    template<typename... Args>
+    void emplace(int id, Args&&... args){
+        assert(id >= 0 && !contains(id));
+        if(id >= values.size()){
+            values.resize(id + 1);
+            positions.resize(id + 1, npos);
+        }
+        values[id].emplace(std::forward<Args>(args)...);
+        positions[id] = static_cast<int>(slots.size());
+        slots.push_back(id);
+        siftUp(positions[id]);
+    }
+
+    [[nodiscard]] const T& top() const{
+        assert(!empty());
+        return *values[slots.front()];
+    }
+
+    [[nodiscard]] int topId() const{
+        assert(!empty());
+        return slots.front();
+    }
+
+    /// @return id of the second best element (the best child of the top), if any
+    [[nodiscard]] std::optional<int> secondId() const{
+        if(size() < 2){
+            return std::nullopt;
+        }
+        auto best = firstChild(0);
+        for(int c = best + 1 ; c < std::min(firstChild(0) + D, size()) ; ++c){
+            if(compare(*values[slots[best]], *values[slots[c]])){
+                best = c;
+            }
+        }
+        return slots[best];
+    }
+
+    /// @warning call update(id) after changing the priority of the element
+    T& operator[](int id){
+        assert(contains(id));
+        return *values[id];
+    }
+
+    const T& operator[](int id) const{
+        assert(contains(id));
+        return *values[id];
+    }
+
+    [[nodiscard]] bool contains(int id) const{
+        return id >= 0 && id < positions.size() && positions[id] != npos;
+    }
+
+    /// @brief restore heap property after the priority of id changed
+    void update(int id){
+        assert(contains(id));
+        profiling::count(profiling::Counter::HEAP_UPDATES);
+        auto pos = positions[id];
+        if(pos > 0 && compare(*values[slots[parent(pos)]], *values[id])){
+            siftUp(pos);
+        }
+        else{
+            siftDown(pos);
+        }
+    }
+
+    void pop(){
+        erase(topId());
+    }
+
+    void erase(int id){
+        assert(contains(id));
+        auto pos = positions[id];
+        auto lastPos = static_cast<int>(slots.size()) - 1;
+
+        swapSlots(pos, lastPos);
+        slots.pop_back();
+        positions[id] = npos;
+        values[id].reset();
+
+        if(pos < slots.size()){
+            update(slots[pos]);
+        }
+    }
+
+    void clear(){
+        slots.clear();
+        values.clear();
+        positions.clear();
+    }
+
+    [[nodiscard]] int size() const{
+        return static_cast<int>(slots.size());
+    }
+
+    [[nodiscard]] bool empty() const{
+        return slots.empty();
+    }
+
+    /// @return bytes of the heap arrays, including the elements but not what they allocate
+    [[nodiscard]] std::size_t getMemoryUsage() const{
+        return values.capacity() * sizeof(std::optional<T>) + (positions.capacity() + slots.capacity()) * sizeof(int);
+    }
+
+    /// @return ids in heap array order (not sorted)
+    [[nodiscard]] const std::vector<int>& ids() const{
+        return slots;
+    }
+
+    /// @return ids of the best N elements, sorted, as topIds(N) without allocations
+    template<int N>
+    [[nodiscard]] boost::container::static_vector<int, N> topIds() const{
+        static_assert(N >= 1);
+        boost::container::static_vector<int, N> result;
+        if(empty()){
+            return result;
+        }
+        if constexpr (N == 1){
+            result.push_back(topId());
+        }
+        else{
+            // every visit removes a slot and adds at most D
+            boost::container::static_vector<int, 1 + N * (D - 1)> frontier{0};
+            auto slotCompare = [this](int a, int b){ return compare(*values[slots[a]], *values[slots[b]]); };
+
+            while(!frontier.empty() && result.size() < N){
+                auto bestIt = std::max_element(frontier.begin(), frontier.end(), slotCompare);
+                auto pos = *bestIt;
+                frontier.erase(bestIt);
+
+                result.push_back(slots[pos]);
+                for(int c = firstChild(pos) ; c < std::min(firstChild(pos) + D, size()) ; ++c){
+                    frontier.push_back(c);
+                }
+            }
+        }
+        return result;
+    }
+
+    /// @return ids of the best n elements, sorted
+    [[nodiscard]] std::vector<int> topIds(int n) const{
+        std::vector<int> result;
+        if(empty() || n <= 0){
+            return result;
+        }
+        result.reserve(n);
+
+        // best first visit of the heap tree, the frontier holds at most n * D slots
+        std::vector<int> frontier{0};
+        auto slotCompare = [this](int a, int b){ return compare(*values[slots[a]], *values[slots[b]]); };
+
+        while(!frontier.empty() && result.size() < n){
+            auto bestIt = std::max_element(frontier.begin(), frontier.end(), slotCompare);
+            auto pos = *bestIt;
+            frontier.erase(bestIt);
+
+            result.push_back(slots[pos]);
+            for(int c = firstChild(pos) ; c < std::min(firstChild(pos) + D, size()) ; ++c){
+                frontier.push_back(c);
+            }
+        }
+        return result;
+    }
+
+private:
+    static constexpr int npos = -1;
+
+    Compare compare;
+    // element of id i, empty if i is not in the heap
+    std::vector<std::optional<T>> values{};
+    // id -> slot
+    std::vector<int> positions{};
+    // slot -> id
+    std::vector<int> slots{};
+
+    static int parent(int pos) { return (pos - 1) / D; }
+    static int firstChild(int pos) { return pos * D + 1; }
+
+    void swapSlots(int a, int b){
+        std::swap(slots[a], slots[b]);
+        positions[slots[a]] = a;
+        positions[slots[b]] = b;
+    }
+
+    void siftUp(int pos){
+        while(pos > 0 && compare(*values[slots[parent(pos)]], *values[slots[pos]])){
+            swapSlots(pos, parent(pos));
+            pos = parent(pos);
+        }
+    }
+
+    void siftDown(int pos){
+        while(true){
+            auto best = pos;
+            auto first = firstChild(pos);
+            auto last = std::min(first + D, size());
+            for(int c = first ; c < last ; ++c){
+                if(compare(*values[slots[best]], *values[slots[c]])){
+                    best = c;
+                }
+            }
+            if(best == pos){
+                return;
+            }
+            swapSlots(pos, best);
+            pos = best;
+        }
+    }
+};
+
+#endif //SIMULTANEOUS_CMAPD_INDEXEDHEAP_HPP
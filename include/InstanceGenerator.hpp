@@ -0,0 +1,71 @@
+#ifndef SIMULTANEOUS_CMAPD_INSTANCEGENERATOR_HPP
+#define SIMULTANEOUS_CMAPD_INSTANCEGENERATOR_HPP
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "Coord.hpp"
+#include "TypeDefs.hpp"
+
+// synthetic instances in the formats read by AmbientMap, loadAgents, loadTasks and DistanceMatrix
+namespace generator {
+
+    /**
+     * @brief warehouse made of blocks of shelves, every block is a row of shelves with endpoints above and below
+     * @details blocks are separated by aisles of aisleWidth cells, the whole warehouse is surrounded by an aisle
+     */
+    struct WarehouseLayout{
+        int nBlockRows = 5;
+        int nBlockCols = 2;
+        // shelf cells of each block
+        int shelfLength = 16;
+        int aisleWidth = 1;
+    };
+
+    struct GeneratedTask{
+        Coord start;
+        Coord goal;
+        TimeStep releaseTime = 0;
+    };
+
+    // rows of the grid, cells are CellType characters
+    using Grid = std::vector<std::string>;
+
+    Grid warehouseGrid(const WarehouseLayout &layout);
+
+    Grid loadGrid(const std::filesystem::path &gridFile);
+
+    /**
+     * @brief BFS distances between all cells, as doubles with shape (nRows, nCols, nRows, nCols)
+     * @details obstacles and unreachable cells have distance 1e9, memory grows with the square of the cells
+     */
+    std::vector<double> distanceMatrix(const Grid &grid);
+
+
+    /**
+     * @brief tasks between endpoints, every endpoint is used by a single task (well formed instance)
+     * @param skew pickups are drawn with weight 1 / (rank + 1)^skew, rank being the distance order of the endpoint from
+     * the top left corner (0 for uniform pickups), deliveries are uniform
+     * @param horizon release times are uniform in [0, horizon), 0 to release all tasks at time 0
+     * @throw std::invalid_argument if there are less than 2 nTasks endpoints
+     */
+    std::vector<GeneratedTask> randomTasks(const Grid &grid, int nTasks, double skew, TimeStep horizon,
+                                           std::mt19937 &gen);
+
+    /**
+     * @brief agents on distinct endpoints not used by tasks
+     * @details idle agents stay on their initial cell, so aisles are left free for the others
+     * @throw std::invalid_argument if there are not enough free endpoints
+     */
+    std::vector<Coord> randomAgents(const Grid &grid, int nAgents, const std::vector<GeneratedTask> &tasks,
+                                    std::mt19937 &gen);
+
+    void saveGrid(const std::filesystem::path &file, const Grid &grid);
+    void saveDistanceMatrix(const std::filesystem::path &file, const Grid &grid);
+    void saveAgents(const std::filesystem::path &file, const std::vector<Coord> &agents);
+    // release times are written only if some of them is not 0
+    void saveTasks(const std::filesystem::path &file, const std::vector<GeneratedTask> &tasks);
+}
+
+#endif //SIMULTANEOUS_CMAPD_INSTANCEGENERATOR_HPP
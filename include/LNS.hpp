@@ -0,0 +1,61 @@
+#ifndef SIMULTANEOUS_CMAPD_LNS_HPP
+#define SIMULTANEOUS_CMAPD_LNS_HPP
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include "Status.hpp"
+#include "AgentInfo.hpp"
+#include "ThreadPool.hpp"
+
+enum class Neighborhood{
+    RANDOM,
+    // tasks with pickup close to the one of a random task
+    SPATIAL,
+    // tasks of the most delayed agents
+    WORST_AGENTS
+};
+
+struct Solution{
+    Status status;
+    // TTD of each agent plan
+    std::vector<TimeStep> agentsTTD;
+
+    [[nodiscard]] TimeStep getTotalDelay() const;
+};
+
+/**
+ * @class LNS
+ * @brief large neighborhood search: remove a set of tasks, reinsert them with BigH and keep the solution if it improves
+ * @details every round evaluates one neighborhood per pool thread, each one on its own copy of the solution
+ */
+class LNS {
+public:
+    LNS(const std::vector<AgentInfo> &agents, Heuristic heuristic, int neighborhoodSize, bool lazy, ThreadPool &pool);
+
+    /// @return number of accepted moves
+    int run(Solution &solution, std::chrono::steady_clock::time_point deadline);
+
+private:
+    static constexpr int nNeighborhoods = 3;
+
+    const std::vector<AgentInfo> &agents;
+    Heuristic heuristic;
+    int neighborhoodSize;
+    bool lazy;
+    ThreadPool &pool;
+
+    [[nodiscard]] std::vector<int>
+    selectTasks(Neighborhood neighborhood, const Solution &solution, std::mt19937 &gen) const;
+
+    [[nodiscard]] Solution destroyAndRepair(const Solution &solution, const std::vector<int> &taskIds) const;
+
+    // drop taskIds from the agent plans, replanning the agents involved
+    void removeTasks(Solution &solution, const std::vector<int> &taskIds) const;
+
+    // greedy insertion of taskIds, the same of SCMAPD::solve
+    template<typename HeuristicPolicy>
+    void reinsertTasks(Solution &solution, const std::vector<int> &taskIds) const;
+};
+
+#endif //SIMULTANEOUS_CMAPD_LNS_HPP
@@ -17,8 +17,13 @@ public:
     bool contains(CompressedCoord loc, TimeStep t) const;
 
     void clear();
+
+    /// @return approximated heap bytes of the explored states
+    [[nodiscard]] std::size_t getMemoryUsage() const;
 private:
     std::unordered_map<CompressedCoord, std::unordered_set<TimeStep>> exploredSet{};
+    // explored (location, time) pairs
+    std::size_t nStates = 0;
 };
 
 
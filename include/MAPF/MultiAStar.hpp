@@ -11,20 +11,34 @@
 class MultiAStar {
 public:
     MultiAStar() = default;
+    /**
+     * @param startTime the agent waits in agentLoc until startTime, the wait is not checked against the other paths
+     */
     std::pair<Path, WaypointsList>
-    solve(WaypointsList &&waypoints, CompressedCoord agentLoc, const Status &status, int agentId);
+    solve(WaypointsList &&waypoints, CompressedCoord agentLoc, const Status &status, int agentId, TimeStep startTime = 0);
+
+    /// @return approximated peak bytes of nodes and explored states of a single search, over all the searches so far
+    static std::size_t getPeakMemoryUsage();
 private:
     static inline auto compareNodesPtr = [](const std::shared_ptr<Node>& nA, const std::shared_ptr<Node>& nB){
         return *nA < *nB;
     };
 
     ExploredSet exploredSet;
+    // nodes after this time step are not expanded, it bounds the search when the goal is unreachable
+    TimeStep horizon = 0;
     std::set<std::shared_ptr<Node>, decltype(compareNodesPtr)> frontier;
+    // nodes created by the actual search, they stay alive through the parent pointers until the frontier is cleared
+    std::size_t nNodes = 0;
+
+    void updatePeakMemoryUsage() const;
 
     void updateFrontier(const std::shared_ptr<Node>& parentPtr, const std::vector<CompressedCoord> &neighbors, const DistanceMatrix &dm,
-                        CompressedCoord targetPos);
+                        CompressedCoord targetPos, TimeStep earliestArrival);
 
-    TimeStep fillPath(const Status &status, int agentId, CompressedCoord goalLoc, std::list<CompressedCoord> &pathList);
+    // goalLoc is reached not before earliestArrival, the agent waits if needed
+    TimeStep fillPath(const Status &status, int agentId, CompressedCoord goalLoc, TimeStep earliestArrival, bool finalGoal,
+                      std::list<CompressedCoord> &pathList);
 };
 
 
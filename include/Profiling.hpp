@@ -0,0 +1,169 @@
+#ifndef SIMULTANEOUS_CMAPD_PROFILING_HPP
+#define SIMULTANEOUS_CMAPD_PROFILING_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief wall time of the solver phases and counters of its kernels, reported as JSON
+ * @details everything is compiled out unless CMAPD_PROFILING is defined (cmake -DCMAPD_PROFILING=ON)
+ */
+namespace profiling {
+
+#ifdef CMAPD_PROFILING
+    inline constexpr bool enabled = true;
+#else
+    inline constexpr bool enabled = false;
+#endif
+
+    enum class Phase{
+        LOAD,
+        BIG_H_BUILD,
+        SOLVE_ITERATION,
+        VALIDATION,
+        N_PHASES
+    };
+
+    enum class Counter{
+        A_STAR_CALLS,
+        NODE_EXPANSIONS,
+        NEIGHBOR_CHECKS,
+        INSERTION_CANDIDATES,
+        HEAP_UPDATES,
+        REPLANS,
+        N_COUNTERS
+    };
+
+    // cycles, instructions, cache misses and branch misses
+    inline constexpr int nHardwareCounters = 4;
+    using HardwareCounts = std::array<std::uint64_t, nHardwareCounters>;
+
+    namespace detail{
+        inline constexpr std::size_t cacheLineSize = 64;
+
+        // one cache line for each thread, so counting does not invalidate the slots of the others
+        struct alignas(cacheLineSize) CounterSlots{
+            std::array<std::atomic<long long>, static_cast<int>(Counter::N_COUNTERS)> counts{};
+        };
+
+        // slots are owned by a global registry, freed slots are reused by the threads started later
+        CounterSlots &registerThread();
+
+        // adds the counts of slots to the totals of the exited threads, then frees slots
+        void releaseThread(CounterSlots &slots);
+
+        // slots of the calling thread, released on thread exit
+        class ThreadSlots {
+        public:
+            ThreadSlots() : slots{registerThread()} {}
+
+            ThreadSlots(const ThreadSlots&) = delete;
+            ThreadSlots &operator=(const ThreadSlots&) = delete;
+
+            ~ThreadSlots(){
+                releaseThread(slots);
+            }
+
+            CounterSlots &slots;
+        };
+
+        extern std::atomic<bool> hardwareActive;
+
+        // sum of the hardware counters of all the attached threads
+        HardwareCounts readHardwareCounters();
+
+        void openThreadCounters();
+
+        void addPhaseTime(Phase phase, std::chrono::steady_clock::duration elapsed, const HardwareCounts *counts);
+    }
+
+    /**
+     * @brief open the hardware counters (perf_event_open) of the calling thread, they are then added to every phase
+     * @details counts are user space only, threads started later are counted if they call attachThread
+     * @return empty string on success, otherwise the reason why counters are not available
+     */
+    std::string startHardwareCounters();
+
+    /// @brief count the calling thread too, if hardware counters are running
+    inline void attachThread(){
+        if constexpr(enabled){
+            if(detail::hardwareActive.load(std::memory_order_relaxed)){
+                detail::openThreadCounters();
+            }
+        }
+    }
+
+    /// @brief add n to counter, each thread writes its own slots so no synchronization is needed
+    inline void count(Counter counter, long long n = 1){
+        if constexpr(enabled){
+            thread_local detail::ThreadSlots thread;
+            auto& slot = thread.slots.counts[static_cast<int>(counter)];
+            slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @class ScopedTimer
+     * @brief adds the time elapsed (and hardware events counted) since construction to phase, on destruction or on the
+     * first call to stop
+     * @details hardware counters are read in every thread, so phases must start and stop while the pool is idle
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Phase phase) : phase{phase} {
+            if constexpr(enabled){
+                if(detail::hardwareActive.load(std::memory_order_relaxed)){
+                    startCounts = detail::readHardwareCounters();
+                }
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer &operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer(){
+            stop();
+        }
+
+        void stop(){
+            if constexpr(enabled){
+                if(running){
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    if(detail::hardwareActive.load(std::memory_order_relaxed)){
+                        auto counts = detail::readHardwareCounters();
+                        // scaled counts of multiplexed groups are not monotonic
+                        for(int i = 0 ; i < nHardwareCounters ; ++i){
+                            counts[i] = counts[i] > startCounts[i] ? counts[i] - startCounts[i] : 0;
+                        }
+                        detail::addPhaseTime(phase, elapsed, &counts);
+                    }
+                    else{
+                        detail::addPhaseTime(phase, elapsed, nullptr);
+                    }
+                    running = false;
+                }
+            }
+        }
+
+    private:
+        Phase phase;
+        bool running = true;
+        std::chrono::steady_clock::time_point start{};
+        HardwareCounts startCounts{};
+    };
+
+    /**
+     * @brief write phases (calls, total and max time in ms, hardware events if started) and counters summed over all
+     * threads
+     * @warning counters of threads still running are read while they may change
+     */
+    void writeReport(std::ostream &os);
+}
+
+#endif //SIMULTANEOUS_CMAPD_PROFILING_HPP
@@ -1,33 +1,206 @@
 #ifndef SIMULTANEOUS_CMAPD_SCMAPD_HPP
 #define SIMULTANEOUS_CMAPD_SCMAPD_HPP
 
+#include <cstdio>
 #include <filesystem>
+#include <istream>
 #include <unordered_set>
 #include <list>
 #include <vector>
+#include <chrono>
 #include "Status.hpp"
 #include "Assignment.hpp"
 #include "BigH.hpp"
+#include "ThreadPool.hpp"
+#include "LNS.hpp"
+#include "Solver.hpp"
+
+// bytes in use at the last measure and the highest measure so far
+struct MemoryUsage{
+    std::size_t current = 0;
+    std::size_t peak = 0;
+
+    void update(std::size_t bytes);
+};
+
+struct RepairReport{
+    // agents replanned to solve the conflicts caused by the event
+    std::vector<int> replannedAgents;
+    // tasks moved from a stopped agent to the others
+    std::vector<int> reassignedTasks;
+    // tasks on board of a stopped agent, they will not be delivered
+    std::vector<int> lostTasks;
+    // agents that could not be replanned after the event, see SCMAPD::getWaitingAgents
+    std::vector<int> waitingAgents;
+    std::chrono::duration<double, std::milli> latency{};
+};
 
 class SCMAPD {
 public:
     SCMAPD(AmbientMap&& ambientMap, const std::vector<AgentInfo> &agents,
-           std::vector<Task> &&tasksVector, Heuristic heuristic, bool debug);
+           std::vector<Task> &&tasksVector, const SolverOptions &options, bool debug);
+
+    // map and distance matrix are only read, so they can be shared by solvers running in parallel
+    SCMAPD(std::shared_ptr<const AmbientMap> ambientMap, const std::vector<AgentInfo> &agents,
+           std::vector<Task> &&tasksVector, const SolverOptions &options, bool debug);
+
+    /**
+     * @brief greedy insertion of all tasks (the ones not kept from the warm start) within a wall clock budget
+     * @details when the budget runs out the remaining tasks are inserted in degraded mode (see BigH::extractTopDegraded),
+     * if it does not, leftover time is used to improve the solution. If a checkpoint file is set the state is saved
+     * periodically during the insertion (see saveCheckpoint)
+     */
+    void solve(std::chrono::milliseconds cutOffTime);
+
+    /**
+     * @brief large neighborhood search on the solution found by solve
+     * @return number of improving moves
+     */
+    int optimize(std::chrono::milliseconds budget);
+
+    /**
+     * @brief online insertion: execute the plan until releaseTime, then insert newTasks in it
+     * @details only the agents receiving new tasks are replanned, the cutoff works as in solve (without improvement)
+     */
+    void addTasks(std::vector<Task> &&newTasks, TimeStep releaseTime, std::chrono::milliseconds cutOffTime);
 
-    void solve(TimeStep cutOffTime);
+    /**
+     * @brief execute the plan until time, then remove taskId from it
+     * @details only the agent serving the task is replanned, tasks already picked up cannot be cancelled
+     * @return true if the task was removed from the plan
+     */
+    bool cancelTask(int taskId, TimeStep time);
 
-    void printResult() const;
+    /**
+     * @brief read task lines (with release time, in non decreasing order) from input and insert them with addTasks
+     * @details lines cancel,taskId,time call cancelTask, the latency of every batch and cancellation is printed
+     */
+    void stream(std::istream &input, std::chrono::milliseconds cutOffTime);
+
+    /**
+     * @brief execute the plan until time, then agentId stays still for delay time steps
+     * @details agentId follows its plan afterwards and only the agents in conflict with its new path are replanned
+     */
+    RepairReport delayAgent(int agentId, TimeStep delay, TimeStep time);
+
+    /**
+     * @brief execute the plan until time, then agentId breaks down and becomes an obstacle
+     * @details tasks not picked up yet are inserted in the plans of the other agents, the cutoff works as in addTasks
+     */
+    RepairReport stopAgent(int agentId, TimeStep time, std::chrono::milliseconds cutOffTime);
+
+    /**
+     * @brief read disruption lines (time,agent,delay or time,agent,stop) from input and repair the plan after each
+     * @details prints the latency of every repair
+     */
+    void replayDisruptions(std::istream &input, std::chrono::milliseconds cutOffTime);
+
+    /**
+     * @brief execute the plan until every task is delivered
+     * @details with a conflict window the plan is conflict free only within it, so it is executed replanPeriod steps at a
+     * time, replanning the agents in conflict in the new window after each step
+     */
+    void execute();
+
+    // for every agent, the steps already executed followed by its plan
+    [[nodiscard]] std::vector<Path> getFullPaths() const;
+
+    // waypoints still to visit by agentId, in visiting order
+    [[nodiscard]] const WaypointsList &getWaypoints(int agentId) const;
+
+    // paths, followed by the waypoints still to visit (the format read by the warm start)
+    void printResult(std::FILE *out = stdout) const;
 
     void printCheckMessage() const;
+
+    // true if some pair of full paths (see getFullPaths) collides
+    [[nodiscard]] bool hasCollisions() const;
+
+    // sum over tasks of delivery time - ideal delivery time
+    [[nodiscard]] TimeStep getTotalDelay() const;
+
+    // tasks inserted after the cutoff, in insertion order
+    [[nodiscard]] const std::vector<int> &getDegradedTasks() const;
+
+    // agents whose waypoints could not be replanned, they wait in their position and are replanned at every step
+    [[nodiscard]] std::vector<int> getWaitingAgents() const;
+
+    // current and peak memory of every subsystem, SmallH entries are compared with the ones of uncompressed paths
+    void printMemoryReport(std::FILE *out = stdout) const;
 private:
     Status status;
-    BigH bigH;
+    std::vector<AgentInfo> agents;
+    ThreadPool pool;
+    AnyBigH bigH;
     bool debug;
+    Heuristic heuristic;
+    bool lazyUpdates;
+    int lnsNeighborhoodSize;
+    int batchSize;
+    TimeStep replanPeriod;
+    std::filesystem::path checkpointFile;
+    int checkpointInterval;
+    // TTD of the last path fixed for each agent
+    std::vector<TimeStep> agentsTTD;
+    std::vector<int> degradedTasks;
+    std::vector<bool> stoppedAgents;
+    // waypoints of the waiting agents, out of the status until a path through them is found
+    std::vector<WaypointsList> waitingWaypoints;
 
-};
+    bool compactEntries;
+    bool memoryReport;
+    int memoryReportInterval;
+    MemoryUsage statusPathsMemory{};
+    MemoryUsage statusWaypointsMemory{};
+    MemoryUsage entriesMemory{};
+    MemoryUsage entriesFullPathMemory{};
+
+    void updateMemoryPeaks();
+
+    // keep the plans of options.resumeFrom or options.warmStart, if any, and return the tasks the heap has to insert
+    static std::vector<int> seedStatus(Status &status, const std::vector<AgentInfo> &agents, const SolverOptions &options);
+
+    // agents start from their actual position, with the TTD of their actual plan
+    void syncAgentsWithStatus();
+
+    void fixTask(int taskId, PathWrapper &&pathWrapper);
+
+    // execute the plan for dt time steps, repairing the conflict window every replanPeriod steps
+    void advance(TimeStep dt);
 
-SCMAPD loadData(const std::filesystem::path &agentsFile, const std::filesystem::path &tasksFile,
-                const std::filesystem::path &gridFile, const std::filesystem::path &distanceMatrixFile,
-                Heuristic heuristic);
+    // replan, one after the other, the agents whose path has conflicts within the window
+    void repairWindow();
+
+    // agents without a path are ignored by the planner, before executing the plan they become obstacles in their
+    // position and the paths running into them are replanned
+    void placeIdleAgents();
+
+    /**
+     * @brief plan again the path through the waypoints of agentId, waiting in its position until startTime
+     * @return false if there is no path, the agent then waits in its position (see getWaitingAgents) and the moving
+     * agents in conflict with it are replanned
+     */
+    bool replanAgent(int agentId, TimeStep startTime = 0);
+    // same, with new waypoints
+    bool replanAgent(int agentId, WaypointsList &&waypoints, TimeStep startTime = 0);
+
+    // try again to plan the waiting agents
+    void replanWaitingAgents();
+
+    // replan the moving agents in conflict with agentId, the replanned ones
+    std::vector<int> repairConflicts(int agentId);
+
+    // agents that can receive new tasks
+    [[nodiscard]] std::vector<AgentInfo> getAvailableAgents() const;
+
+    // greedy loop of solve, with degraded insertion after the deadline, checkpointInterval 0 saves no checkpoint
+    template<typename BigHType>
+    void insertTasks(BigHType &specializedBigH, std::chrono::steady_clock::time_point deadline,
+                     int checkpointInterval = 0);
+
+    // rebuild agent plans inserting their tasks by ideal delivery time, keeping the ones that reduce the delay
+    void improve(std::chrono::steady_clock::time_point deadline);
+
+};
 
 #endif //SIMULTANEOUS_CMAPD_SCMAPD_HPP
@@ -0,0 +1,113 @@
+#ifndef SIMULTANEOUS_CMAPD_SERVER_HPP
+#define SIMULTANEOUS_CMAPD_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "AmbientMap.hpp"
+#include "Solver.hpp"
+
+struct ServerOptions{
+    // nThreads is the number of threads of every solve
+    SolverOptions solver{};
+    // budget of the requests that do not set one
+    std::chrono::milliseconds cutOffTime{1000};
+    // connections served at the same time, the others wait to be accepted
+    int nWorkers = 1;
+    // connections whose client sends or reads nothing for idleTimeout are closed, 0 to keep them open
+    std::chrono::milliseconds idleTimeout{60000};
+    // latency statistics are computed on the last latencyWindow solve requests
+    std::size_t latencyWindow = 10000;
+};
+
+// latencies in ms, from the end of the request to the end of the response
+struct LatencyStats{
+    long long requests = 0;
+    // solve requests answered with an error or whose response could not be sent
+    long long errors = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+/**
+ * @class SolverServer
+ * @brief solves instances on a map loaded once, received as binary requests on a Unix domain socket
+ * @details every message is a 4 bytes little endian payload length followed by the payload, integers in the payload
+ * are LEB128 varints and coordinates are row, col pairs. A connection can send any number of requests, each answered
+ * before the next one is read, and holds a worker until it is closed or stays idle for ServerOptions::idleTimeout.
+ * Request payloads start with their type:
+ *  - 'S' solve: cutoff in ms (0 for the server default), nAgents, the agent positions, nTasks, then for each task its
+ *  pickup, its delivery and its release time. Tasks are indexed in request order.
+ *  - 'L' latency statistics.
+ *
+ * Responses start with 'E' followed by the length and the bytes of an error message, or with 'O' followed by:
+ *  - solve: collisions flag (1 byte), total delay, then for each agent its path length, its first position, one byte
+ *  per move (the index in AmbientMap::directionVector), the number of waypoints still to visit and for each of them
+ *  its task, 'p' or 'd' (1 byte) and its arrival time.
+ *  - latency statistics: length and bytes of a JSON object with the fields of LatencyStats (see writeLatencyStats).
+ */
+class SolverServer {
+public:
+    SolverServer(std::shared_ptr<const AmbientMap> ambientMap, const ServerOptions &options);
+
+    SolverServer(const SolverServer&) = delete;
+    SolverServer &operator=(const SolverServer&) = delete;
+
+    /**
+     * @brief listen on socketPath and serve the connections until stop is called, then remove the socket
+     * @details a stale socket file left by a crashed server is replaced
+     * @throw std::runtime_error if the socket cannot be created or another server is listening on it
+     */
+    void run(const std::filesystem::path &socketPath);
+
+    /// @brief make run return, closing the open connections (async signal safe)
+    void stop();
+
+    [[nodiscard]] LatencyStats getLatencyStats() const;
+
+private:
+    std::shared_ptr<const AmbientMap> ambientMap;
+    ServerOptions options;
+    std::atomic<bool> stopRequested{false};
+
+    // accepted connections waiting for a worker
+    std::mutex connectionsMutex;
+    std::condition_variable connectionsCv;
+    std::deque<int> pendingConnections;
+    std::unordered_set<int> activeConnections;
+    bool closing = false;
+
+    mutable std::mutex statsMutex;
+    // ring buffer of the last latencyWindow latencies
+    std::vector<double> latencies;
+    std::size_t nextLatency = 0;
+    long long nRequests = 0;
+    long long nErrors = 0;
+
+    void workerLoop();
+
+    void serveConnection(int fd);
+
+    // response to a request payload, errors included
+    std::string handleRequest(const std::string &request);
+
+    std::string solve(const std::string &request);
+
+    void recordLatency(std::chrono::duration<double, std::milli> latency, bool failed);
+};
+
+// LatencyStats as a JSON object
+std::string writeLatencyStats(const LatencyStats &stats);
+
+#endif //SIMULTANEOUS_CMAPD_SERVER_HPP
@@ -2,38 +2,48 @@
 #define SIMULTANEOUS_CMAPD_SMALLH_HPP
 
 #include <vector>
-#include <boost/heap/fibonacci_heap.hpp>
+#include <functional>
 #include "Assignment.hpp"
 #include "Status.hpp"
 #include "AgentInfo.hpp"
+#include "IndexedHeap.hpp"
 
-// todo check if heap is max or min
-using SmallHFibHeap = boost::heap::fibonacci_heap<Assignment, boost::heap::compare<std::greater<>>>;
-using SmallHHandles = std::unordered_map<int, SmallHFibHeap::handle_type>;
+// min heap on MCA, indexed by agent id
+using SmallHHeap = IndexedHeap<Assignment, std::greater<>>;
 
 class SmallH {
 public:
-    SmallH(const std::vector<AgentInfo> &agentsInfos, int taskId, int v, const Status &status);
+    SmallH(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status, bool compact);
 
     PathWrapper extractTopAndReset();
+    // bring the top entry up to date without looking at the others, then extract it
+    PathWrapper extractRefreshedTopAndReset(const Status &status);
     [[nodiscard]] TimeStep getTopMCA() const;
-
-    void updateTopElements(const Path &fixedPath, const Status &status);
+    [[nodiscard]] const Assignment &getTopAssignment() const;
+    // MCA of the second best agent, equal to the top one if there is a single agent
+    [[nodiscard]] TimeStep getSecondMCA() const;
 
     void addTaskToAgent(int k, int otherTaskId, const Status &status);
 
+    /**
+     * @brief bring the top V entries up to date: add the tasks fixed for their agent and replan them if they conflict
+     * with some path updated since their last validation, returns true if some of them were stale
+     * @details entries below the top V are left stale and checked once they reach it, against all the paths fixed
+     * in the meantime. V is the v of the heuristic policy, instantiated in SmallH.cpp
+     */
+    template<int V>
+    bool refreshTopElements(const Status &status);
+
     int getTaskId() const;
 
+    [[nodiscard]] AssignmentMemory getMemoryUsage() const;
+
 private:
     int taskId;
-    int v;
-    SmallHFibHeap heap;
-    SmallHHandles heapHandles;
-
-    static SmallHFibHeap
-    initializeHeap(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status);
+    SmallHHeap heap;
 
-    static SmallHHandles getHandles(const SmallHFibHeap& heap);
+    static SmallHHeap
+    initializeHeap(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status, bool compact);
 };
 
 
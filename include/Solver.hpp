@@ -0,0 +1,128 @@
+#ifndef SIMULTANEOUS_CMAPD_SOLVER_HPP
+#define SIMULTANEOUS_CMAPD_SOLVER_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <vector>
+#include "AmbientMap.hpp"
+#include "Coord.hpp"
+#include "TypeDefs.hpp"
+
+/**
+ * @brief entry point of cmapd_core, instances are solved from memory or from the files read by cmapd
+ * @details the map is built once (see AmbientMap(const std::vector<std::string>&, DistanceMatrix&&) and
+ * DistanceMatrix(std::shared_ptr<const double>, int, int)) and can be shared by solves running in parallel
+ */
+
+struct SolverOptions{
+    Heuristic heuristic = Heuristic::MCA;
+    int nThreads = 1;
+    // recompute SmallH entries only when they reach the top of a heap
+    bool lazyUpdates = false;
+    // store SmallH paths compressed, decoding them only when extracted
+    bool compactEntries = false;
+    // keep track of the memory used by the distance matrix, status, SmallH entries and A* during solve
+    bool memoryReport = false;
+    // print the memory in use every memoryReportInterval iterations of the greedy loop, 0 to disable
+    int memoryReportInterval = 0;
+    // number of tasks removed and reinserted by every LNS move
+    int lnsNeighborhoodSize = 10;
+    // max number of tasks fixed by each iteration, followed by a single heap update
+    int batchSize = 1;
+    // resolve conflicts only in the next conflictWindow time steps, 0 for the whole horizon
+    TimeStep conflictWindow = 0;
+    // time steps executed between two repairs of the window, 0 for conflictWindow
+    TimeStep replanPeriod = 0;
+    // result of a previous run (see solveFiles) whose plans are kept, empty to start from scratch
+    std::filesystem::path warmStart{};
+    // checkpoint saved by a preempted solve, the insertion resumes from its plans
+    std::filesystem::path resumeFrom{};
+    // file rewritten by solve every checkpointInterval iterations of the greedy loop, empty to disable
+    std::filesystem::path checkpointFile{};
+    int checkpointInterval = 100;
+};
+
+struct TaskSpec{
+    Coord pickup;
+    Coord delivery;
+    TimeStep releaseTime = 0;
+};
+
+struct SolveOptions{
+    SolverOptions solver{};
+    std::chrono::milliseconds cutOffTime{10000};
+    // budget of the LNS improvement phase, 0 to skip it
+    std::chrono::milliseconds lnsBudget{0};
+    // capacity of every agent, as loadAgents
+    int agentCapacity = 3;
+};
+
+// a waypoint still to visit, task is the index in the tasks of the instance
+struct PlannedStop{
+    int task;
+    Demand demand;
+    TimeStep arrivalTime;
+};
+
+struct SolveResult{
+    // for every agent, its position at every time step from 0
+    std::vector<std::vector<Coord>> paths{};
+    // for every agent, its waypoints in visiting order
+    std::vector<std::vector<PlannedStop>> stops{};
+    // sum over tasks of delivery time - ideal delivery time
+    TimeStep totalDelay = 0;
+    bool collisions = false;
+    // tasks inserted after the cutoff, in insertion order
+    std::vector<int> degradedTasks{};
+    // agents left waiting in their position with waypoints no path was found for
+    std::vector<int> waitingAgents{};
+    std::chrono::duration<double, std::milli> time{};
+};
+
+/**
+ * @brief solve an instance on ambientMap, with agents at the given positions and tasks indexed in the given order
+ * @details the LNS phase runs if it has a budget, windowed plans (solver.conflictWindow > 0) are executed with repairs
+ * as in cmapd
+ * @throw std::invalid_argument if there are no agents or a position is outside the map or on an obstacle
+ */
+SolveResult solveInstance(const std::shared_ptr<const AmbientMap> &ambientMap, const std::vector<Coord> &agents,
+                          const std::vector<TaskSpec> &tasks, const SolveOptions &options);
+
+// files of an instance, in the formats read by AmbientMap, DistanceMatrix, loadAgents and loadTasks
+struct InstanceFiles{
+    std::filesystem::path gridFile;
+    std::filesystem::path distanceMatrixFile;
+    std::filesystem::path agentsFile;
+    std::filesystem::path tasksFile;
+};
+
+// events replayed after the solve, null to skip them
+struct SolveEvents{
+    // agent delays (time,agent,steps) and breakdowns (time,agent,stop)
+    std::istream *disruptions = nullptr;
+    // tasks with release time (yStart,xStart,yGoal,xGoal,release) and cancellations (cancel,taskId,time)
+    std::istream *stream = nullptr;
+};
+
+/**
+ * @brief solve an instance read from files, as cmapd does
+ * @details after the LNS phase the disruptions and then the stream are replayed, cutOffTime being the budget of every
+ * insertion, and windowed plans are executed; the repairs and insertions are reported on stdout
+ * @param resultOut if not null, the plans are printed there in the format read by SolverOptions::warmStart, followed
+ * by the memory report if solver.memoryReport is set
+ */
+SolveResult solveFiles(const InstanceFiles &files, const SolveOptions &options, const SolveEvents &events = {},
+                       std::FILE *resultOut = nullptr);
+
+/**
+ * @brief solve the agents and tasks files of an instance on ambientMap, as solveFiles(const InstanceFiles&, ...)
+ * @details for the tools loading the map once for many instances
+ */
+SolveResult solveFiles(const std::shared_ptr<const AmbientMap> &ambientMap, const std::filesystem::path &agentsFile,
+                       const std::filesystem::path &tasksFile, const SolveOptions &options,
+                       const SolveEvents &events = {}, std::FILE *resultOut = nullptr);
+
+#endif //SIMULTANEOUS_CMAPD_SOLVER_HPP
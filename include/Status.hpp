@@ -6,15 +6,26 @@
 #define SIMULTANEOUS_CMAPD_STATUS_HPP
 
 #include <unordered_set>
+#include <memory>
+#include <optional>
 
 #include "Task.hpp"
 #include "AmbientMap.hpp"
+#include "AgentInfo.hpp"
+#include "Waypoint.hpp"
 
 class Status{
 public:
     Status(AmbientMap &&ambientMap,
            int nRobots,
-           std::vector<Task> && tasks);
+           std::vector<Task> && tasks,
+           TimeStep conflictWindow = 0);
+
+    // ambient shared with other solvers, e.g. instances of a batch on the same map
+    Status(std::shared_ptr<const AmbientMap> ambientMap,
+           int nRobots,
+           std::vector<Task> && tasks,
+           TimeStep conflictWindow = 0);
 
     // t is the time when agent does the action
     std::vector<CompressedCoord> getValidNeighbors(int agentId, CompressedCoord c, TimeStep t) const;
@@ -25,18 +36,92 @@ public:
 
     const Task & getTask(int i) const;
 
-    void updatePaths(Path &&path, int agentId);
+    // path together with the waypoints it visits (arrival times are absolute)
+    void updatePaths(Path &&path, WaypointsList &&waypoints, int agentId);
+
+    // waypoints still to be visited by agentId, deliveries of tasks already picked up have no pickup
+    const WaypointsList &getWaypoints(int agentId) const;
+
+    /**
+     * @brief execute the plan for dt time steps
+     * @details visited waypoints are dropped (their delay is added to the completed one), executed path steps are moved
+     * to the history and paths are rebased, so that index 0 is the new actual time. Agents with an empty path wait at
+     * the start position in agents
+     */
+    void advance(TimeStep dt, const std::vector<AgentInfo> &agents);
+
+    // tasks become visible to the planner, their indices must follow the ones of the actual tasks
+    void addTasks(std::vector<Task> &&newTasks);
+
+    // simulated time corresponding to index 0 of the paths
+    TimeStep getElapsedTime() const;
+
+    // delay of the tasks already delivered
+    TimeStep getCompletedDelay() const;
+
+    // positions visited by agentId before the actual time
+    const Path &getExecutedPath(int agentId) const;
+
+    // record that taskId has been fixed in the plan of agentId
+    void assignTask(int taskId, int agentId);
+
+    // replace the tasks fixed for agentId, its path must be updated accordingly
+    void setAssignedTasks(int agentId, std::vector<int> &&taskIds);
+
+    // tasks fixed for agentId, in assignment order
+    const std::vector<int> &getAssignedTasks(int agentId) const;
+
+    // agent with taskId in its plan, if any (delivered tasks are not in any plan)
+    std::optional<int> getTaskAgent(int taskId) const;
+
+    // incremented by every path update, used to know if a cached path is stale
+    int getVersion() const;
 
     bool checkAllConflicts() const;
     bool checkPathConflicts(int i, int j) const;
+    // agents whose path is in conflict with the one of agentId
+    std::vector<int> getConflictingAgents(int agentId) const;
     bool checkPathWithStatus(const Path &path, int agentId) const;
+    // true if an agent other than agentId is in c at time t or later, so agentId cannot stop there at time t
+    bool checkFinalPosition(int agentId, CompressedCoord c, TimeStep t) const;
+    // check only paths updated after version sinceVersion
+    bool checkPathWithStatus(const Path &path, int agentId, int sinceVersion) const;
+
+    // window > 0 checks only the time steps from 0 to window, unless one of the paths ends within them
+    static bool checkPathConflicts(const Path &pA, const Path &pB, TimeStep window = 0) ;
+
+    /**
+     * @brief conflicts are resolved only up to window time steps ahead, included (0 means the whole horizon)
+     * @details beyond the window only agents whose path ends within it are obstacles, so plans must be repaired before
+     * being executed past it
+     */
+    TimeStep getConflictWindow() const;
 
-    static bool checkPathConflicts(const Path &pA, const Path &pB) ;
     const DistanceMatrix &getDistanceMatrix() const;
+    const AmbientMap &getAmbientMap() const;
+    /// @return approximated heap bytes of planned and executed paths
+    [[nodiscard]] std::size_t getPathsMemoryUsage() const;
+
+    /// @return approximated heap bytes of the waypoints of the plans
+    [[nodiscard]] std::size_t getWaypointsMemoryUsage() const;
 private:
-    const AmbientMap ambient;
-    const std::vector<Task> tasksVector;
+    // immutable data is shared between copies, so that a copy is a cheap snapshot of the plan
+    std::shared_ptr<const AmbientMap> ambient;
+    std::shared_ptr<const std::vector<Task>> tasksVector;
     std::vector<Path> paths;
+    std::vector<std::vector<int>> assignedTasks;
+    // inverse of assignedTasks, -1 for tasks not in a plan
+    std::vector<int> taskAgents;
+    std::vector<WaypointsList> waypoints;
+
+    TimeStep elapsedTime = 0;
+    TimeStep completedDelay = 0;
+    std::vector<Path> executedPaths;
+
+    int version = 0;
+    std::vector<int> pathsVersion;
+
+    TimeStep conflictWindow = 0;
 
     bool checkDynamicObstacle(int agentId, CompressedCoord coord1, CompressedCoord coord2, TimeStep t1) const;
 };
@@ -6,7 +6,8 @@
 #include "utils.hpp"
 
 struct Task {
-    Task(CompressedCoord startLoc, CompressedCoord goalLoc, const DistanceMatrix& dm);
+    // index must be the position of the task in the status tasks
+    Task(CompressedCoord startLoc, CompressedCoord goalLoc, TimeStep releaseTime, int index, const DistanceMatrix& dm);
 
     const CompressedCoord startLoc;
     const CompressedCoord goalLoc;
@@ -21,11 +22,12 @@ struct Task {
 
     explicit operator std::string() const;
     explicit operator std::pair<CompressedCoord, CompressedCoord>() const{return getCoordinates();}
-
-private:
-    static int generateId();
 };
 
+// task lines are yStart,xStart,yGoal,xGoal[,releaseTime], tasks are indexed from 0 in file order
 std::vector<Task> loadTasks(const std::filesystem::path &tasksFilePath, const DistanceMatrix &dm, char horizontalSep=',');
 
+// parse a single task line, index must be the position of the task in the status tasks
+Task parseTask(const std::string &line, int index, const DistanceMatrix &dm, char horizontalSep=',');
+
 #endif //SIMULTANEOUS_CMAPD_TASK_HPP
@@ -0,0 +1,65 @@
+#ifndef SIMULTANEOUS_CMAPD_THREADPOOL_HPP
+#define SIMULTANEOUS_CMAPD_THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <utility>
+
+/**
+ * @class ThreadPool
+ * @brief fixed size pool with one work queue per thread, idle threads steal work from the others
+ */
+class ThreadPool {
+public:
+    /// @param nThreads total number of threads, caller included (values < 1 are treated as 1)
+    explicit ThreadPool(int nThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief run body(i) for every i in [0, n) and wait for completion
+     * @warning body must be safe to call concurrently for different indices
+     */
+    void parallelFor(int n, const std::function<void(int)> &body);
+
+    [[nodiscard]] int size() const;
+
+private:
+    struct Chunk{
+        int begin;
+        int end;
+        const std::function<void(int)>* body;
+    };
+
+    struct WorkQueue{
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex jobMutex;
+    std::condition_variable jobCv;
+    std::condition_variable doneCv;
+    unsigned generation = 0;
+    bool stop = false;
+
+    std::atomic<int> pendingChunks = 0;
+    std::exception_ptr firstException;
+
+    void workerLoop(int queueId);
+    // execute chunks until there is nothing left to pop or steal
+    void drain(int queueId);
+    bool popOrSteal(int queueId, Chunk &chunk);
+};
+
+#endif //SIMULTANEOUS_CMAPD_THREADPOOL_HPP
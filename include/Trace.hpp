@@ -0,0 +1,99 @@
+#ifndef SIMULTANEOUS_CMAPD_TRACE_HPP
+#define SIMULTANEOUS_CMAPD_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "Profiling.hpp"
+
+/**
+ * @brief scoped events in the Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+ * @details compiled only with CMAPD_PROFILING, events are recorded after startTrace in a ring buffer per thread,
+ * so only the last events of each thread are kept
+ */
+namespace profiling {
+
+    namespace detail{
+        struct TraceEvent{
+            // static string, only the pointer is stored
+            const char *name;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::duration duration;
+            int agentId;
+            int taskId;
+        };
+
+        struct TraceBuffer{
+            int threadIndex;
+            std::vector<TraceEvent> events;
+            // number of events ever recorded, the last events.size() ones are kept
+            std::atomic<std::size_t> nRecorded{0};
+        };
+
+        extern std::atomic<bool> traceActive;
+
+        TraceBuffer &registerTraceThread();
+
+        inline void record(const TraceEvent &event){
+            thread_local TraceBuffer &buffer = registerTraceThread();
+            auto n = buffer.nRecorded.load(std::memory_order_relaxed);
+            buffer.events[n % buffer.events.size()] = event;
+            buffer.nRecorded.store(n + 1, std::memory_order_release);
+        }
+    }
+
+    /// @brief start recording, keeping at most eventsPerThread events for each thread
+    void startTrace(std::size_t eventsPerThread);
+
+    /**
+     * @brief write the recorded events as a trace event JSON object, times in microseconds from startTrace
+     * @warning call it when the solver threads are idle
+     */
+    void writeTrace(std::ostream &os);
+
+    /**
+     * @class TraceScope
+     * @brief complete event from construction to destruction, agent and task ids are optional arguments
+     */
+    class TraceScope {
+    public:
+        explicit TraceScope(const char *name, int agentId = -1, int taskId = -1) :
+            name{name},
+            agentId{agentId},
+            taskId{taskId}
+        {
+            if constexpr(enabled){
+                if(detail::traceActive.load(std::memory_order_relaxed)){
+                    active = true;
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope &operator=(const TraceScope&) = delete;
+
+        ~TraceScope(){
+            if constexpr(enabled){
+                if(active){
+                    detail::record({name, start, std::chrono::steady_clock::now() - start, agentId, taskId});
+                }
+            }
+        }
+
+        // ids known only inside the scope
+        void setAgent(int id){ agentId = id; }
+        void setTask(int id){ taskId = id; }
+
+    private:
+        const char *name;
+        int agentId;
+        int taskId;
+        bool active = false;
+        std::chrono::steady_clock::time_point start{};
+    };
+}
+
+#endif //SIMULTANEOUS_CMAPD_TRACE_HPP
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <list>
+#include <optional>
+#include <string_view>
 #include "Coord.hpp"
 
 using TimeStep = int;
@@ -20,5 +22,20 @@ enum class Heuristic{
     RMCA_R
 };
 
+namespace heuristics{
+    inline std::optional<Heuristic> fromString(std::string_view name){
+        if(name == "MCA"){
+            return Heuristic::MCA;
+        }
+        if(name == "RMCA_A"){
+            return Heuristic::RMCA_A;
+        }
+        if(name == "RMCA_R"){
+            return Heuristic::RMCA_R;
+        }
+        return std::nullopt;
+    }
+}
+
 
 #endif //SIMULTANEOUS_CMAPD_TYPEDEFS_HPP
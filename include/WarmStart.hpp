@@ -0,0 +1,32 @@
+#ifndef SIMULTANEOUS_CMAPD_WARMSTART_HPP
+#define SIMULTANEOUS_CMAPD_WARMSTART_HPP
+
+#include <filesystem>
+#include <vector>
+#include "Status.hpp"
+#include "AgentInfo.hpp"
+
+struct PlannedWaypoint{
+    Demand demand;
+    int taskId;
+    Coord position;
+};
+
+// waypoints of each agent in visiting order
+using WarmStart = std::vector<std::vector<PlannedWaypoint>>;
+
+/**
+ * @brief read the waypoints table printed by SCMAPD::printResult
+ * @details every other line of the file is ignored
+ */
+WarmStart loadWarmStart(const std::filesystem::path &resultFile);
+
+/**
+ * @brief fix in status the plans of a previous run, replanning their paths
+ * @details tasks whose waypoints do not match the actual tasks are dropped, agents whose plan exceeds their capacity
+ * or cannot be made conflict free start with an empty plan
+ * @return ids of the tasks left to insert
+ */
+std::vector<int> applyWarmStart(const WarmStart &warmStart, const std::vector<AgentInfo> &agents, Status &status);
+
+#endif //SIMULTANEOUS_CMAPD_WARMSTART_HPP
@@ -0,0 +1,236 @@
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "Solver.hpp"
+
+namespace py = pybind11;
+
+namespace {
+    // the map shared by the solves, AmbientMap is exposed only through it
+    struct Map{
+        std::shared_ptr<const AmbientMap> ambientMap;
+    };
+
+    using GridArray = py::array_t<std::uint8_t, py::array::c_style | py::array::forcecast>;
+    using IndexArray = py::array_t<int, py::array::c_style | py::array::forcecast>;
+
+    // keeps the NumPy array alive as long as a DistanceMatrix references its buffer
+    struct ArrayOwner{
+        py::object array;
+
+        // the last reference may be dropped by a solve running without the GIL
+        void operator()(const double *){
+            py::gil_scoped_acquire gil;
+            array = py::object{};
+        }
+    };
+
+    DistanceMatrix viewDistances(const py::array &distances){
+        // no conversion, a copy of the matrix would defeat the point
+        if(!distances.dtype().equal(py::dtype::of<double>()) || !distances.dtype().attr("isnative").cast<bool>()){
+            throw py::value_error("distances must be a float64 array in native byte order");
+        }
+        if(!(distances.flags() & py::array::c_style) || !distances.attr("flags").attr("aligned").cast<bool>()){
+            throw py::value_error("distances must be a C contiguous and aligned array");
+        }
+        if(distances.ndim() != 4 || distances.shape(0) * distances.shape(1) != distances.shape(2) * distances.shape(3)){
+            throw py::value_error("distances must have shape (rows, cols, rows, cols)");
+        }
+        return {
+            std::shared_ptr<const double>{static_cast<const double*>(distances.data()), ArrayOwner{distances}},
+            static_cast<int>(distances.shape(0)),
+            static_cast<int>(distances.shape(1))
+        };
+    }
+
+    // int array of an array like of integers, a cast would truncate floats and wrap the values outside int
+    IndexArray toIntArray(const py::object &object, const std::string &name){
+        const auto array = py::array::ensure(object);
+        if(!array){
+            throw py::value_error(name + " must be an array of integers");
+        }
+        if(array.size() > 0){
+            const auto kind = array.dtype().attr("kind").cast<std::string>();
+            if(kind != "i" && kind != "u"){
+                throw py::value_error(name + " must be an array of integers");
+            }
+            const py::int_ min{std::numeric_limits<int>::min()};
+            const py::int_ max{std::numeric_limits<int>::max()};
+            if(array.attr("min")() < min || array.attr("max")() > max){
+                throw py::value_error(name + " out of the range of int");
+            }
+        }
+        return IndexArray::ensure(array);
+    }
+
+    std::vector<Coord> toAgents(const py::object &agents){
+        const auto array{toIntArray(agents, "agents")};
+        if(array.ndim() != 2 || array.shape(1) != 2){
+            throw py::value_error("agents must have shape (n, 2), one row, col pair per agent");
+        }
+        auto a = array.unchecked<2>();
+        std::vector<Coord> positions;
+        positions.reserve(a.shape(0));
+        for(py::ssize_t i = 0 ; i < a.shape(0) ; ++i){
+            positions.push_back({a(i, 0), a(i, 1)});
+        }
+        return positions;
+    }
+
+    std::vector<TaskSpec> toTasks(const py::object &tasks){
+        const auto array{toIntArray(tasks, "tasks")};
+        if(array.size() == 0){
+            return {};
+        }
+        if(array.ndim() != 2 || (array.shape(1) != 4 && array.shape(1) != 5)){
+            throw py::value_error("tasks must have shape (n, 4) or (n, 5), as in the tasks files");
+        }
+        auto t = array.unchecked<2>();
+        std::vector<TaskSpec> specs;
+        specs.reserve(t.shape(0));
+        for(py::ssize_t i = 0 ; i < t.shape(0) ; ++i){
+            TimeStep releaseTime = t.shape(1) == 5 ? t(i, 4) : 0;
+            if(releaseTime < 0){
+                throw py::value_error("negative release time of task " + std::to_string(i));
+            }
+            specs.push_back({{t(i, 0), t(i, 1)}, {t(i, 2), t(i, 3)}, releaseTime});
+        }
+        return specs;
+    }
+
+    // (length, 2) array on the buffer of path, which is moved into the array
+    py::array_t<int> toArray(std::vector<Coord> &&path){
+        static_assert(sizeof(Coord) == 2 * sizeof(int));
+
+        auto owner = std::make_unique<std::vector<Coord>>(std::move(path));
+        const auto* data = reinterpret_cast<const int*>(owner->data());
+        const auto length = static_cast<py::ssize_t>(owner->size());
+        py::capsule base{owner.get(), [](void *p){ delete static_cast<std::vector<Coord>*>(p); }};
+        owner.release();
+
+        return py::array_t<int>(
+            {length, py::ssize_t{2}},
+            {static_cast<py::ssize_t>(sizeof(Coord)), static_cast<py::ssize_t>(sizeof(int))},
+            data,
+            base
+        );
+    }
+
+    py::dict toDict(SolveResult &&result){
+        py::list paths;
+        for(auto& path : result.paths){
+            paths.append(toArray(std::move(path)));
+        }
+
+        py::list stops;
+        for(const auto& agentStops : result.stops){
+            py::list list;
+            for(const auto& stop : agentStops){
+                list.append(py::make_tuple(stop.task, stop.demand == Demand::PICKUP ? "p" : "d", stop.arrivalTime));
+            }
+            stops.append(list);
+        }
+
+        py::dict dict;
+        dict["paths"] = paths;
+        dict["stops"] = stops;
+        dict["total_delay"] = result.totalDelay;
+        dict["collisions"] = result.collisions;
+        dict["degraded_tasks"] = result.degradedTasks;
+        dict["waiting_agents"] = result.waitingAgents;
+        dict["time_ms"] = result.time.count();
+        return dict;
+    }
+
+    py::dict solve(const Map &map, const py::object &agents, const py::object &tasks, double cutoff, double lns,
+                   const std::string &heuristic, int threads, int batch, int window, int replanEvery, bool lazy,
+                   bool compact){
+        auto parsedHeuristic{heuristics::fromString(heuristic)};
+        if(!parsedHeuristic){
+            throw py::value_error("heuristic must be MCA, RMCA_A or RMCA_R, not " + heuristic);
+        }
+        if(window < 0 || replanEvery < 0 || (window > 0 && replanEvery > window)){
+            throw py::value_error("window and replan_every must be >= 0, with replan_every <= window");
+        }
+
+        SolveOptions options{
+            .solver = {
+                .heuristic = *parsedHeuristic,
+                .nThreads = threads,
+                .lazyUpdates = lazy,
+                .compactEntries = compact,
+                .batchSize = batch,
+                .conflictWindow = window,
+                .replanPeriod = replanEvery
+            },
+            .cutOffTime = std::chrono::milliseconds{static_cast<long>(cutoff * 1000)},
+            .lnsBudget = std::chrono::milliseconds{static_cast<long>(lns * 1000)}
+        };
+        auto positions = toAgents(agents);
+        auto specs = toTasks(tasks);
+
+        // copied under the GIL, the solve owns its reference to the map
+        auto ambientMap = map.ambientMap;
+        SolveResult result;
+        {
+            // other Python threads run meanwhile, the map is only read
+            py::gil_scoped_release release;
+            result = solveInstance(ambientMap, positions, specs, options);
+        }
+        return toDict(std::move(result));
+    }
+}
+
+PYBIND11_MODULE(pycmapd, m) {
+    m.doc() = "Simultaneous CMAPD solver, see Solver.hpp";
+
+    py::class_<Map>(m, "Map", "grid and distance matrix, loaded once and shared by all the solves")
+        .def(py::init([](const std::vector<std::string> &grid, const py::array &distances){
+                return Map{std::make_shared<const AmbientMap>(grid, viewDistances(distances))};
+            }),
+            py::arg("grid"), py::arg("distances").noconvert(),
+            "grid as the lines of a grid file, distances as a C contiguous, aligned float64 array in native byte "
+            "order of shape (rows, cols, rows, cols), e.g. numpy.load(file, mmap_mode='r'). The distances are not "
+            "copied: the map keeps a reference to the array, which must not be modified")
+        .def(py::init([](const GridArray &grid, const py::array &distances){
+                if(grid.ndim() != 2){
+                    throw py::value_error("grid must have shape (rows, cols)");
+                }
+                std::vector<std::string> rows;
+                rows.reserve(grid.shape(0));
+                for(py::ssize_t r = 0 ; r < grid.shape(0) ; ++r){
+                    rows.emplace_back(reinterpret_cast<const char*>(grid.data(r, 0)), grid.shape(1));
+                }
+                return Map{std::make_shared<const AmbientMap>(rows, viewDistances(distances))};
+            }),
+            py::arg("grid"), py::arg("distances").noconvert(),
+            "grid as an array of shape (rows, cols) of cell characters ('.', '@', 'G') as uint8, distances as above")
+        .def_static("load", [](const std::string &gridFile, const std::string &distanceMatrixFile){
+                return Map{std::make_shared<const AmbientMap>(gridFile, DistanceMatrix{distanceMatrixFile})};
+            },
+            py::arg("grid_file"), py::arg("distance_matrix_file"), "map of a grid file and a .npy distance matrix")
+        .def_property_readonly("n_rows", [](const Map &map){ return map.ambientMap->getNRows(); })
+        .def_property_readonly("n_cols", [](const Map &map){ return map.ambientMap->getNCols(); });
+
+    m.def("solve", &solve,
+          py::arg("map"), py::arg("agents"), py::arg("tasks"), py::kw_only(),
+          py::arg("cutoff") = 10., py::arg("lns") = 0., py::arg("heuristic") = "MCA", py::arg("threads") = 1,
+          py::arg("batch") = 1, py::arg("window") = 0, py::arg("replan_every") = 0, py::arg("lazy") = false,
+          py::arg("compact") = false,
+          R"(solve an instance on map, releasing the GIL while solving
+
+agents is an array like of integers of shape (n, 2) of row, col positions, tasks one of shape (n, 4) or (n, 5) of
+pickup row, col, delivery row, col and optional release time; floats and values outside int raise ValueError. Options
+are the ones of cmapd, with budgets in seconds.
+
+Returns a dict with
+  paths: for every agent an int32 array of shape (length, 2), its row, col at every time step
+  stops: for every agent the waypoints still to visit, as (task, 'p' or 'd', arrival time)
+  total_delay, collisions, degraded_tasks (tasks inserted after the cutoff), waiting_agents (agents left waiting with
+  waypoints no path was found for) and time_ms)");
+}
@@ -0,0 +1,86 @@
+"""solve data/test.agents and data/test.tasks on data/grid.txt through pycmapd
+
+usage: smoke_test.py grid_file distance_matrix_file agents_file tasks_file, with pycmapd on the PYTHONPATH
+"""
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pycmapd
+
+
+def load_rows(file):
+    # the first line is the number of rows
+    with open(file) as f:
+        return np.array([[int(v) for v in line.split(",")] for line in f.read().split()[1:]], dtype=np.int32)
+
+
+def check(result, agents, tasks):
+    assert not result["collisions"], "collisions"
+    assert result["total_delay"] >= 0
+    assert result["degraded_tasks"] == [] and result["waiting_agents"] == []
+    assert len(result["paths"]) == len(agents) and len(result["stops"]) == len(agents)
+
+    visited = set()
+    for agent, path in zip(agents, result["paths"]):
+        assert path.dtype == np.int32 and path.ndim == 2 and path.shape[1] == 2
+        assert tuple(path[0]) == tuple(agent), "path not starting from the agent"
+        assert (np.abs(np.diff(path, axis=0)).sum(axis=1) <= 1).all(), "not a unit move"
+        visited.update(map(tuple, path))
+    for pickup_row, pickup_col, delivery_row, delivery_col in tasks[:, :4]:
+        assert (pickup_row, pickup_col) in visited and (delivery_row, delivery_col) in visited, "task not served"
+
+
+def expect_value_error(call, what):
+    try:
+        call()
+    except ValueError:
+        pass
+    else:
+        raise AssertionError(what + " accepted")
+
+
+def main(grid_file, distance_matrix_file, agents_file, tasks_file):
+    agents = load_rows(agents_file)
+    tasks = load_rows(tasks_file)
+
+    with open(grid_file) as f:
+        grid = f.read().split()
+    distances = np.load(distance_matrix_file, mmap_mode="r")
+    cells = np.array([list(row.encode()) for row in grid], dtype=np.uint8)
+
+    maps = [
+        pycmapd.Map.load(grid_file, distance_matrix_file),
+        pycmapd.Map(grid, distances),
+        pycmapd.Map(cells, distances),
+    ]
+    for map in maps:
+        assert (map.n_rows, map.n_cols) == (len(grid), len(grid[0]))
+        check(pycmapd.solve(map, agents, tasks, cutoff=1.), agents, tasks)
+
+    # the map is shared by solves running in parallel
+    options = [{}, {"heuristic": "RMCA_R"}, {"window": 5, "replan_every": 2}, {"lazy": True, "compact": True}]
+    with ThreadPoolExecutor(len(options)) as executor:
+        results = executor.map(lambda o: pycmapd.solve(maps[1], agents, tasks, cutoff=1., **o), options)
+        for result in results:
+            check(result, agents, tasks)
+
+    expect_value_error(lambda: pycmapd.solve(maps[0], agents, tasks, heuristic="MCB"), "unknown heuristic")
+
+    # distances that would be misread in place are rejected, not copied
+    swapped = distances.astype(distances.dtype.newbyteorder())
+    buffer = np.zeros(distances.nbytes + 1, dtype=np.uint8)
+    unaligned = np.frombuffer(buffer, dtype=np.float64, count=distances.size, offset=1).reshape(distances.shape)
+    expect_value_error(lambda: pycmapd.Map(grid, swapped), "byte swapped distances")
+    expect_value_error(lambda: pycmapd.Map(grid, unaligned), "unaligned distances")
+
+    # positions are neither truncated nor wrapped
+    expect_value_error(lambda: pycmapd.solve(maps[0], agents + 0.7, tasks), "float agents")
+    expect_value_error(lambda: pycmapd.solve(maps[0], [[1.7, 2]], tasks), "float agents")
+    expect_value_error(lambda: pycmapd.solve(maps[0], agents.astype(np.int64) + 2**40, tasks), "agents out of int")
+
+    print("pycmapd ok")
+
+
+if __name__ == "__main__":
+    main(*sys.argv[1:])
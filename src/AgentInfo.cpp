@@ -4,6 +4,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <stdexcept>
 #include "DistanceMatrix.hpp"
 #include "AgentInfo.hpp"
 
@@ -11,6 +12,9 @@ std::vector<AgentInfo>
 loadAgents(const std::filesystem::path &agentsFilePath, const DistanceMatrix &dm, char horizontalSep,
            int capacity) {
     std::ifstream fs (agentsFilePath, std::ios::in);
+    if(!fs){
+        throw std::runtime_error("Cannot open agents file " + agentsFilePath.string());
+    }
     std::string line;
 
     // nAgents line
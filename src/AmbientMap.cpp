@@ -4,24 +4,27 @@
 #include "AmbientMap.hpp"
 #include "DistanceMatrix.hpp"
 
-std::fstream AmbientMap::openGridFile(const std::filesystem::path &gridPath){
+std::vector<std::string> AmbientMap::readGridFile(const std::filesystem::path &gridPath){
     std::fstream fs(gridPath.c_str(), std::ios::in);
 
     if(!fs.is_open()){
         throw std::runtime_error("Grid file doesn' t exist");
     }
 
-    return fs;
+    std::vector<std::string> rows;
+    for(std::string line ; std::getline(fs, line) ; ){
+        rows.push_back(std::move(line));
+    }
+    return rows;
 }
 
 
-std::vector<std::vector<CellType>> AmbientMap::getGrid(std::fstream &&data) {
+std::vector<std::vector<CellType>> AmbientMap::getGrid(const std::vector<std::string> &rows) {
     std::list<std::list<CellType>> tmpGrid;
 
     using namespace boost::algorithm;
 
-    std::string line;
-    while(std::getline(data, line)){
+    for(auto line : rows){
         std::list<CellType> row;
 
         trim(line);
@@ -48,6 +51,9 @@ std::vector<std::vector<CellType>> AmbientMap::getGrid(std::fstream &&data) {
     grid.reserve(nRows);
 
     for(const auto& tmpRow : tmpGrid){
+        if(tmpRow.size() != nCols){
+            throw std::runtime_error("Grid rows have different lengths");
+        }
         std::vector<CellType> row{tmpRow.begin(), tmpRow.end()};
         grid.push_back(row);
     }
@@ -76,16 +82,21 @@ int AmbientMap::getNCols() const {
 
 std::optional<CompressedCoord> AmbientMap::movement(CompressedCoord coord, int directionIndex) const{
     assert(directionIndex >= 0 && directionIndex < directionVector.size());
-    auto neighbor = coord + distanceMatrix.from2Dto1D(directionVector[directionIndex]);
+    // bounds are checked on the 2D coordinate, the 1D offset would wrap around the first and last column
+    auto neighbor = distanceMatrix.from1Dto2D(coord) + directionVector[directionIndex];
 
-    return isValid(distanceMatrix.from1Dto2D(neighbor)) ? std::optional{neighbor} : std::nullopt;
+    return isValid(neighbor) ? std::optional{distanceMatrix.from2Dto1D(neighbor)} : std::nullopt;
 }
 
 AmbientMap::AmbientMap(const std::filesystem::path &gridPath, DistanceMatrix&& dm) :
+    AmbientMap{readGridFile(gridPath), std::move(dm)}
+{}
+
+AmbientMap::AmbientMap(const std::vector<std::string> &rows, DistanceMatrix&& dm) :
     distanceMatrix{std::move(dm)},
-    grid{getGrid(openGridFile(gridPath))}
+    grid{getGrid(rows)}
 {
-    if(dm.nRows != grid.size() || (!grid.empty() && dm.nCols != grid[0].size())){
+    if(distanceMatrix.nRows != grid.size() || (!grid.empty() && distanceMatrix.nCols != grid[0].size())){
         throw std::runtime_error("Grid file and distance matrix file do not refer to same ambient");
     }
 }
@@ -10,15 +10,30 @@
 
 #include "Assignment.hpp"
 #include "MAPF/MultiAStar.hpp"
+#include "Profiling.hpp"
+#include "Trace.hpp"
 
-Assignment::Assignment(const AgentInfo &agentInfo, int firstTaskId, const Status &status) :
+Assignment::Assignment(const AgentInfo &agentInfo, bool compact) :
         startPos{agentInfo.startPos},
-        waypoints{},
         index{agentInfo.index},
-        capacity{agentInfo.capacity}
+        capacity{agentInfo.capacity},
+        waypoints{},
+        compact{compact}
+    {}
+
+Assignment::Assignment(const AgentInfo &agentInfo, int firstTaskId, const Status &status, bool compact) :
+        Assignment(agentInfo, compact)
     {
+        // start from the plan already fixed for the agent
+        waypoints = WaypointsList(status.getWaypoints(index));
+        nSyncedTasks = static_cast<int>(status.getAssignedTasks(index).size());
+        for(const auto& w : waypoints){
+            initialLoad -= static_cast<int>(w.demand);
+        }
+
         addTask(firstTaskId, status);
-        assert(path.size() > 2 && path[0] == startPos && waypoints.size() == 2);
+        assert(getMaterializedPath().size() > 2 && getMaterializedPath()[0] == startPos);
+        assert(waypoints.size() == status.getWaypoints(index).size() + 2);
         assert(agentInfo.index == index);
     }
 
@@ -44,6 +59,7 @@ bool Assignment::empty() const {
 
 void
 Assignment::addTask(int taskId, const Status &status) {
+    profiling::TraceScope trace{"Assignment::addTask", index, taskId};
 
 #ifndef NDEBUG
     auto oldWaypointSize = waypoints.size();
@@ -52,12 +68,14 @@ Assignment::addTask(int taskId, const Status &status) {
     insertTaskWaypoints(taskId, status);
 
     MultiAStar pathfinder{};
-    std::tie(path, waypoints) = pathfinder.solve(std::move(waypoints), startPos, status, index);
-    assert(!status.checkPathWithStatus(path, index));
+    auto [newPath, newWaypoints] = pathfinder.solve(std::move(waypoints), startPos, status, index);
+    waypoints = std::move(newWaypoints);
+    setPath(std::move(newPath), status);
 
 #ifndef NDEBUG
     assert(oldWaypointSize == waypoints.size() - 2);
-    int sum = 0;
+    // tasks picked up before the plan begins have only the delivery
+    int sum = initialLoad;
     for(const auto& w : waypoints){
         sum += static_cast<int>(w.demand);
     }
@@ -65,6 +83,12 @@ Assignment::addTask(int taskId, const Status &status) {
 #endif
 }
 
+void Assignment::addFixedTask(int taskId, const Status &status) {
+    assert(status.getAssignedTasks(index)[nSyncedTasks] == taskId);
+    addTask(taskId, status);
+    ++nSyncedTasks;
+}
+
 void
 Assignment::insertTaskWaypoints(int taskId, const Status &status) {
     const Task& task = status.getTask(taskId);
@@ -76,6 +100,7 @@ Assignment::insertTaskWaypoints(int taskId, const Status &status) {
 
     // we must use end iterator position to explore all possible combinations
     auto lastIteration = waypoints.size() + 1;
+    profiling::count(profiling::Counter::INSERTION_CANDIDATES, static_cast<long long>(lastIteration * (lastIteration + 1) / 2));
 
     auto wpPickupIt = waypoints.begin();
     auto wpDeliveryIt = wpPickupIt;
@@ -88,6 +113,8 @@ Assignment::insertTaskWaypoints(int taskId, const Status &status) {
     // todo fix this waypoints continuously grow
     // search for best position for task start and goal
     for(int i = 0; i < lastIteration ; ++wpPickupIt, ++i){
+        // delivery goes after the pickup
+        wpDeliveryIt = wpPickupIt;
         for (int j = i; j < lastIteration; ++wpDeliveryIt, ++j){
             auto [newStartIt, newGoalIt] = insertNewWaypoints(task, wpPickupIt, wpDeliveryIt);
             if(checkCapacityConstraint()){
@@ -119,7 +146,7 @@ std::pair<WaypointsList::iterator, WaypointsList::iterator> Assignment::insertNe
 }
 
 bool Assignment::checkCapacityConstraint() {
-    int actualWeight = 0;
+    int actualWeight = initialLoad;
 
     for(const auto& waypoint : waypoints){
         actualWeight += static_cast<int>(waypoint.demand);
@@ -142,15 +169,19 @@ TimeStep Assignment::computeApproxTTD(const Status &status, WaypointsList::itera
 
     auto ttd = newPickupWpIt == waypoints.begin() ? 0 : std::prev(newPickupWpIt)->getCumulatedDelay();
     auto prevWpPos = newPickupWpIt == waypoints.begin() ? startPos : std::prev(newPickupWpIt)->position;
-    auto prevArrivalTime = newPickupWpIt == waypoints.begin() ? 0 : std::prev(newPickupWpIt)->getArrivalTime();
+    auto prevArrivalTime = newPickupWpIt == waypoints.begin() ?
+        status.getElapsedTime() : std::prev(newPickupWpIt)->getArrivalTime();
 
     for(auto wpIt = newPickupWpIt ; wpIt != waypoints.end() ; ++wpIt){
         auto arrivalTime = prevArrivalTime + dm.getDistance(prevWpPos, wpIt->position);
+        if(wpIt->demand == Demand::PICKUP){
+            // the agent waits for the release of the task
+            arrivalTime = std::max(arrivalTime, status.getTask(wpIt->taskIndex).releaseTime);
+        }
         if(wpIt->demand == Demand::DELIVERY){
-            // using ideal path
-            // todo fix this (ttd is negative)
+            // using ideal path, pickups wait for the release so deliveries are never early
             ttd += arrivalTime - status.getTask(wpIt->taskIndex).idealGoalTime;
-            assert(ttd > 0);
+            assert(ttd >= 0);
         }
         prevWpPos = wpIt->position;
         prevArrivalTime = arrivalTime;
@@ -165,16 +196,84 @@ bool operator<(const Assignment& a, const Assignment& b){
 }
 
 PathWrapper Assignment::extractAndReset() {
-    waypoints.clear();
+    auto ttd = getActualTTD();
     oldTTD = 0;
-    return {index, std::exchange(path, {})};
+    return {
+        index,
+        compact ? std::exchange(compactPath, {}).decode() : std::exchange(path, {}),
+        ttd,
+        std::exchange(waypoints, {})
+    };
 }
 
 void
 Assignment::internalUpdate(const Status &status) {
     MultiAStar pathfinder{};
-    std::tie(path, waypoints) = pathfinder.solve(std::move(waypoints), startPos, status, index);
-    assert(!status.checkPathWithStatus(path, index));
+    auto [newPath, newWaypoints] = pathfinder.solve(std::move(waypoints), startPos, status, index);
+    waypoints = std::move(newWaypoints);
+    setPath(std::move(newPath), status);
+}
+
+void Assignment::setPath(Path &&newPath, const Status &status) {
+    assert(!status.checkPathWithStatus(newPath, index));
+    // planned against the whole status
+    statusVersion = status.getVersion();
+
+    if(compact){
+        compactPath = CompactPath{newPath, status.getDistanceMatrix().nCols};
+        return;
+    }
+    path = std::move(newPath);
+}
+
+const Path &Assignment::getMaterializedPath() const {
+    if(!compact){
+        return path;
+    }
+
+    thread_local Path buffer{};
+    compactPath.decode(buffer);
+    return buffer;
+}
+
+bool Assignment::hasConflicts(const Path &other, TimeStep window) const {
+    return Status::checkPathConflicts(other, getMaterializedPath(), window);
+}
+
+AssignmentMemory Assignment::getMemoryUsage() const {
+    return {
+        // std::list node: value plus two pointers
+        .waypoints = waypoints.size() * (sizeof(Waypoint) + 2 * sizeof(void*)),
+        .storedPath = path.capacity() * sizeof(CompressedCoord) + compactPath.getMemoryUsage(),
+        .fullPath = (compact ? compactPath.size() : path.size()) * sizeof(CompressedCoord)
+    };
+}
+
+AssignmentMemory &AssignmentMemory::operator+=(const AssignmentMemory &other) {
+    entries += other.entries;
+    waypoints += other.waypoints;
+    storedPath += other.storedPath;
+    fullPath += other.fullPath;
+    return *this;
+}
+
+bool Assignment::isUpToDate(const Status &status) const {
+    return statusVersion == status.getVersion();
+}
+
+void Assignment::refresh(const Status &status) {
+    const auto& fixedTasks = status.getAssignedTasks(index);
+
+    if(nSyncedTasks < fixedTasks.size()){
+        for( ; nSyncedTasks < fixedTasks.size() ; ++nSyncedTasks){
+            addTask(fixedTasks[nSyncedTasks], status);
+        }
+    }
+    else if(status.checkPathWithStatus(getMaterializedPath(), index, statusVersion)){
+        internalUpdate(status);
+    }
+
+    statusVersion = status.getVersion();
 }
 
 const WaypointsList &Assignment::getWaypoints() const {
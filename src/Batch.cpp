@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_set>
+#include <fmt/core.h>
+#include "Batch.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    std::filesystem::path resolve(const std::filesystem::path &file, const std::filesystem::path &base){
+        return file.is_absolute() ? file : base / file;
+    }
+
+    BatchResult solveInstance(const std::shared_ptr<const AmbientMap> &ambientMap, const BatchInstance &instance,
+                              const BatchOptions &options){
+        std::unique_ptr<std::FILE, decltype(&std::fclose)> out{std::fopen(instance.resultFile.c_str(), "w"), &std::fclose};
+        if(!out){
+            throw std::runtime_error("Cannot write " + instance.resultFile.string());
+        }
+        auto solved{solveFiles(ambientMap, instance.agentsFile, instance.tasksFile, options.solve, {}, out.get())};
+        fmt::print(out.get(), "{}\nTotal delay: {}\n", solved.collisions ? "Collisions" : "No collisions", solved.totalDelay);
+
+        return {
+            .solved = true,
+            .collisions = solved.collisions,
+            .totalDelay = solved.totalDelay,
+            .time = solved.time
+        };
+    }
+}
+
+std::vector<BatchInstance> loadManifest(const std::filesystem::path &manifest, const std::filesystem::path &resultDir) {
+    std::ifstream fs(manifest);
+    if(!fs){
+        throw std::runtime_error("Cannot open manifest " + manifest.string());
+    }
+    const auto base = manifest.parent_path();
+
+    std::vector<BatchInstance> instances;
+    std::unordered_set<std::string> resultFiles;
+    int lineNumber = 0;
+    for(std::string line ; std::getline(fs, line) ; ){
+        ++lineNumber;
+        std::istringstream lineStream{line};
+        std::string agentsFile, tasksFile, resultFile;
+        if(!(lineStream >> agentsFile) || agentsFile.front() == '#'){
+            continue;
+        }
+        if(!(lineStream >> tasksFile)){
+            throw std::runtime_error(fmt::format("{}:{}: missing tasks file", manifest.string(), lineNumber));
+        }
+        lineStream >> resultFile;
+
+        BatchInstance instance{
+            resolve(agentsFile, base),
+            resolve(tasksFile, base),
+            resolve(resultFile.empty() ? std::filesystem::path{tasksFile}.stem().string() + ".txt" : resultFile, resultDir)
+        };
+        if(!resultFiles.insert(instance.resultFile.lexically_normal().string()).second){
+            throw std::runtime_error(fmt::format(
+                "{}:{}: result file {} already used by another instance", manifest.string(), lineNumber,
+                instance.resultFile.string()
+            ));
+        }
+        instances.push_back(std::move(instance));
+    }
+    return instances;
+}
+
+std::vector<BatchResult> solveBatch(const std::shared_ptr<const AmbientMap> &ambientMap,
+                                    const std::vector<BatchInstance> &instances, const BatchOptions &options) {
+    std::vector<BatchResult> results(instances.size());
+
+    // every job writes only its own result
+    ThreadPool jobs{options.nJobs};
+    jobs.parallelFor(static_cast<int>(instances.size()), [&](int i){
+        try{
+            results[i] = solveInstance(ambientMap, instances[i], options);
+        }
+        catch(const std::exception &e){
+            results[i].error = e.what();
+            // no partial result is left for a failed instance
+            std::error_code ec;
+            std::filesystem::remove(instances[i].resultFile, ec);
+        }
+    });
+
+    return results;
+}
@@ -1,92 +1,198 @@
-#include <functional>
 #include <algorithm>
+#include <optional>
 #include "BigH.hpp"
-
-SmallHComp BigH::getComparator(Heuristic h) {
-    switch(h){
-        case Heuristic::RMCA_A:
-            return [](const SmallH& a, const SmallH& b) -> bool {
-                        auto aVal = a.getTopMCA() - a.getTopMCA();
-                        auto bVal = b.getTopMCA() - b.getTopMCA();
-
-                        return aVal < bVal;
-                    };
-        case Heuristic::RMCA_R:
-            return [](const SmallH& a, const SmallH& b) -> bool {
-                auto aVal = a.getTopMCA() / a.getTopMCA();
-                auto bVal = b.getTopMCA() / b.getTopMCA();
-
-                return aVal < bVal;
-            };
-        // MCA
-        default:
-            return [](const SmallH& a, const SmallH& b) -> bool {return a.getTopMCA() > b.getTopMCA();};
-    }
-}
-
-BigH::BigH(const std::vector<AgentInfo> &agentInfos, const Status &status, Heuristic h) :
-    v{h == Heuristic::MCA ? 1 : 2},
-    heap{buildPartialAssignmentHeap(agentInfos, status, v, h)},
-    heapHandles{getHandles(heap)},
-    unassignedTaskIndices(boost::counting_iterator<int>(0), boost::counting_iterator<int>(status.getTasks().size()))
+#include "Profiling.hpp"
+#include "Trace.hpp"
+
+template<typename HeuristicPolicy>
+BigH<HeuristicPolicy>::BigH(const std::vector<AgentInfo> &agentInfos, const Status &status, bool lazy, bool compact,
+                            ThreadPool &pool) :
+    BigH(agentInfos, status, allTaskIds(status), lazy, compact, pool)
+    {}
+
+template<typename HeuristicPolicy>
+BigH<HeuristicPolicy>::BigH(const std::vector<AgentInfo> &agentInfos, const Status &status,
+                            const std::vector<int> &taskIds, bool lazy, bool compact, ThreadPool &pool) :
+    lazy{lazy},
+    pool{pool},
+    heap{buildPartialAssignmentHeap(agentInfos, status, taskIds, compact, pool)}
     {
         #ifndef NDEBUG
-        for(int i = 0 ; i < heapHandles.size() ; ++i){
-            assert((*heapHandles[i]).getTaskId() == i);
+        for(int taskId : heap.ids()){
+            assert(heap[taskId].getTaskId() == taskId);
         }
         #endif
     }
 
-ExtractedPath BigH::extractTop() {
+template<typename HeuristicPolicy>
+std::vector<int> BigH<HeuristicPolicy>::allTaskIds(const Status &status) {
+    std::vector<int> taskIds;
+    taskIds.reserve(status.getTasks().size());
+    for(const auto& task : status.getTasks()){
+        taskIds.push_back(task.index);
+    }
+    return taskIds;
+}
+
+template<typename HeuristicPolicy>
+ExtractedPath BigH<HeuristicPolicy>::extractTop(const Status &status) {
     assert(!heap.empty());
 
+    // stale keys are lower bounds: refresh the top until it is up to date
+    while(lazy && heap[heap.topId()].template refreshTopElements<v>(status)){
+        heap.update(heap.topId());
+    }
+
     // atomic block (and order is important)
-    auto topSmallH = std::move(const_cast<SmallH&>(heap.top()));
-    auto taskId = topSmallH.getTaskId();
-    auto pathWrapper = topSmallH.extractTopAndReset();
+    auto taskId = heap.topId();
+    auto pathWrapper = heap[taskId].extractTopAndReset();
     heap.pop();
 
-    unassignedTaskIndices.erase(taskId);
     return {taskId, std::move(pathWrapper)};
 }
 
-bool BigH::empty() const {
-    return heap.empty();
+template<typename HeuristicPolicy>
+ExtractedPath BigH<HeuristicPolicy>::extractTopDegraded(const Status &status) {
+    assert(!heap.empty());
+
+    auto taskId = heap.topId();
+    auto pathWrapper = heap[taskId].extractRefreshedTopAndReset(status);
+    heap.pop();
+
+    return {taskId, std::move(pathWrapper)};
 }
 
-void BigH::update(int k, int taskId, const Status &status) {
-    const auto& fixedPath = status.getPaths()[k];
+template<typename HeuristicPolicy>
+std::vector<ExtractedPath> BigH<HeuristicPolicy>::extractBatch(const Status &status, int maxSize) {
+    std::vector<ExtractedPath> batch;
+    batch.push_back(extractTop(status));
 
-    for(int validHandleId : unassignedTaskIndices){
-        auto& sHHandle = heapHandles[validHandleId];
-        // todo fix this
-        // atomic
-        (*sHHandle).addTaskToAgent(k, taskId, status);
-        (*sHHandle).updateTopElements(fixedPath, status);
-        heap.update(sHHandle);
+    if(maxSize <= 1){
+        return batch;
     }
+
+    // status does not change while the batch is built, so entries stay valid with respect to it
+    for(int candidateId : heap.topIds(maxSize - 1)){
+        const auto& candidate = heap[candidateId].getTopAssignment();
+
+        bool compatible = (!lazy || candidate.isUpToDate(status)) &&
+            std::ranges::none_of(batch, [&](const ExtractedPath &fixed){
+                return fixed.pathWrapper.agentId == candidate.getAgentId() ||
+                    candidate.hasConflicts(fixed.pathWrapper.path, status.getConflictWindow());
+            });
+
+        if(compatible){
+            batch.push_back({candidateId, heap[candidateId].extractTopAndReset()});
+            heap.erase(candidateId);
+        }
+    }
+
+    return batch;
+}
+
+template<typename HeuristicPolicy>
+bool BigH<HeuristicPolicy>::empty() const {
+    return heap.empty();
 }
 
-BigHFibHeap
-BigH::buildPartialAssignmentHeap(const std::vector<AgentInfo> &agentsInfos, const Status &status, int v, Heuristic h) {
-    const auto& tasks = status.getTasks();
+template<typename HeuristicPolicy>
+std::vector<int> BigH<HeuristicPolicy>::getTaskIds() const {
+    std::vector<int> taskIds(heap.ids());
+    std::ranges::sort(taskIds);
+    return taskIds;
+}
 
-    BigHFibHeap heap(getComparator(h));
+template<typename HeuristicPolicy>
+void BigH<HeuristicPolicy>::update(int k, int taskId, const Status &status) {
+    update(std::vector<FixedTask>{{k, taskId}}, status);
+}
 
-    for(const auto& task : status.getTasks()){
-        auto taskId = task.index;
+template<typename HeuristicPolicy>
+void BigH<HeuristicPolicy>::update(const std::vector<FixedTask> &fixedTasks, const Status &status) {
+    // fixed tasks are read from status when entries reach the top
+    if(lazy){
+        return;
+    }
+    profiling::TraceScope trace{"BigH::update"};
+
+    // unassigned tasks
+    const std::vector<int> targetIds = heap.ids();
+
+    // every SmallH is touched by a single thread and status is only read, so no locking is needed
+    pool.parallelFor(static_cast<int>(targetIds.size()), [&](int i){
+        profiling::TraceScope trace{"SmallH::update", -1, targetIds[i]};
+        auto& smallH = heap[targetIds[i]];
+        for(const auto& [k, taskId] : fixedTasks){
+            smallH.addTaskToAgent(k, taskId, status);
+        }
+        smallH.template refreshTopElements<v>(status);
+    });
+
+    // heap structure is not thread safe, fix it afterwards
+    for(int targetId : targetIds){
+        heap.update(targetId);
+    }
+}
+
+template<typename HeuristicPolicy>
+typename BigH<HeuristicPolicy>::Heap
+BigH<HeuristicPolicy>::buildPartialAssignmentHeap(const std::vector<AgentInfo> &agentsInfos, const Status &status,
+                                                  const std::vector<int> &taskIds, bool compact, ThreadPool &pool) {
+    profiling::ScopedTimer timer{profiling::Phase::BIG_H_BUILD};
+
+    std::vector<std::optional<SmallH>> smallHs(taskIds.size());
+    pool.parallelFor(static_cast<int>(taskIds.size()), [&](int i){
+        auto taskId = taskIds[i];
         assert(taskId >= 0 && taskId < status.getTasks().size());
-        heap.emplace(agentsInfos, taskId, v, status);
+        profiling::TraceScope trace{"SmallH::build", -1, taskId};
+        smallHs[i].emplace(agentsInfos, taskId, status, compact);
+    });
+
+    Heap heap{};
+
+    for(auto& smallH : smallHs){
+        auto taskId = smallH->getTaskId();
+        heap.emplace(taskId, std::move(smallH.value()));
     }
 
     return heap;
 }
 
-BigHHandles BigH::getHandles(const BigHFibHeap &heap) {
-    BigHHandles heapHandles{};
+template<typename HeuristicPolicy>
+AssignmentMemory BigH<HeuristicPolicy>::getMemoryUsage() const {
+    AssignmentMemory memory{.entries = heap.getMemoryUsage()};
+    for(int taskId : heap.ids()){
+        memory += heap[taskId].getMemoryUsage();
+    }
+    return memory;
+}
+
+template class BigH<heuristics::MCA>;
+template class BigH<heuristics::RMCA_A>;
+template class BigH<heuristics::RMCA_R>;
 
-    for(auto it = heap.begin(); it != heap.end() ; ++it){
-        heapHandles.emplace(it->getTaskId(), BigHFibHeap::s_handle_from_iterator(it));
+AnyBigH makeBigH(Heuristic h, const std::vector<AgentInfo> &agentInfos, const Status &status,
+                 const std::vector<int> &taskIds, bool lazy, bool compact, ThreadPool &pool) {
+    switch(h){
+        case Heuristic::RMCA_A:
+            return AnyBigH{std::in_place_type<BigH<heuristics::RMCA_A>>, agentInfos, status, taskIds, lazy, compact, pool};
+        case Heuristic::RMCA_R:
+            return AnyBigH{std::in_place_type<BigH<heuristics::RMCA_R>>, agentInfos, status, taskIds, lazy, compact, pool};
+        // MCA
+        default:
+            return AnyBigH{std::in_place_type<BigH<heuristics::MCA>>, agentInfos, status, taskIds, lazy, compact, pool};
+    }
+}
+
+AnyBigH makeBigH(Heuristic h, const std::vector<AgentInfo> &agentInfos, const Status &status, bool lazy, bool compact,
+                 ThreadPool &pool) {
+    switch(h){
+        case Heuristic::RMCA_A:
+            return AnyBigH{std::in_place_type<BigH<heuristics::RMCA_A>>, agentInfos, status, lazy, compact, pool};
+        case Heuristic::RMCA_R:
+            return AnyBigH{std::in_place_type<BigH<heuristics::RMCA_R>>, agentInfos, status, lazy, compact, pool};
+        // MCA
+        default:
+            return AnyBigH{std::in_place_type<BigH<heuristics::MCA>>, agentInfos, status, lazy, compact, pool};
     }
-    return heapHandles;
 }
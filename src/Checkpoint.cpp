@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#include "Checkpoint.hpp"
+
+namespace {
+    constexpr char magic[] = {'C', 'M', 'A', 'P', 'D', 'C', 'K', '2'};
+
+    void writeVarint(std::ostream &os, std::uint64_t value){
+        while(value >= 0x80){
+            os.put(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        os.put(static_cast<char>(value));
+    }
+
+    // zigzag, so that small negative values take a single byte too
+    void writeSigned(std::ostream &os, std::int64_t value){
+        writeVarint(os, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    std::uint64_t readVarint(std::istream &is){
+        std::uint64_t value = 0;
+        for(int shift = 0 ; shift < 64 ; shift += 7){
+            auto byte = is.get();
+            if(byte == std::char_traits<char>::eof()){
+                throw std::runtime_error("Truncated checkpoint");
+            }
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if(!(byte & 0x80)){
+                return value;
+            }
+        }
+        throw std::runtime_error("Corrupted checkpoint");
+    }
+
+    std::int64_t readSigned(std::istream &is){
+        auto value = readVarint(is);
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // value in [0, bound)
+    int readBounded(std::istream &is, std::size_t bound){
+        auto value = readVarint(is);
+        if(value >= bound){
+            throw std::runtime_error("Corrupted checkpoint");
+        }
+        return static_cast<int>(value);
+    }
+
+    // FNV-1a of the tasks and of the agent positions, so that a checkpoint is not restored on another instance
+    std::uint64_t fingerprint(const Status &status, const std::vector<AgentInfo> &agents){
+        std::uint64_t hash = 0xcbf29ce484222325;
+        auto combine = [&](std::int64_t value){
+            for(int i = 0 ; i < 8 ; ++i){
+                hash = (hash ^ ((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF)) * 0x100000001b3;
+            }
+        };
+
+        for(const auto& task : status.getTasks()){
+            combine(task.startLoc);
+            combine(task.goalLoc);
+            combine(task.releaseTime);
+        }
+        for(const auto& agent : agents){
+            combine(agent.startPos);
+        }
+        return hash;
+    }
+
+    // paths start at the agent position and move by one free cell at a time
+    void checkPath(const Path &path, const AgentInfo &agent, const Status &status){
+        const auto& ambientMap = status.getAmbientMap();
+        const auto& dm = status.getDistanceMatrix();
+        auto invalidPath = [&](){
+            return std::runtime_error("Checkpoint path of agent " + std::to_string(agent.index) + " is not valid");
+        };
+
+        if(!path.empty() && path.front() != agent.startPos){
+            throw invalidPath();
+        }
+        for(int t = 0 ; t < path.size() ; ++t){
+            auto c = dm.from1Dto2D(path[t]);
+            if(!ambientMap.isValid(c)){
+                throw invalidPath();
+            }
+            if(t > 0){
+                auto previous = dm.from1Dto2D(path[t - 1]);
+                if(std::abs(c.row - previous.row) + std::abs(c.col - previous.col) > 1){
+                    throw invalidPath();
+                }
+            }
+        }
+    }
+}
+
+void saveCheckpoint(const std::filesystem::path &file, const Status &status, const std::vector<AgentInfo> &agents,
+                    const std::vector<int> &pendingTasks) {
+    auto tmpFile = file;
+    tmpFile += ".tmp";
+
+    {
+        std::ofstream os(tmpFile, std::ios::binary | std::ios::trunc);
+        if(!os){
+            throw std::runtime_error("Cannot write checkpoint " + tmpFile.string());
+        }
+
+        os.write(magic, sizeof(magic));
+        writeVarint(os, status.getPaths().size());
+        writeVarint(os, status.getTasks().size());
+        writeVarint(os, fingerprint(status, agents));
+
+        for(int k = 0 ; k < status.getPaths().size() ; ++k){
+            const auto& path = status.getPaths()[k];
+            writeVarint(os, path.size());
+            CompressedCoord previous = 0;
+            for(auto c : path){
+                writeSigned(os, c - previous);
+                previous = c;
+            }
+
+            // positions follow from the tasks, delays from the arrival times
+            const auto& waypoints = status.getWaypoints(k);
+            writeVarint(os, waypoints.size());
+            for(const auto& wp : waypoints){
+                writeVarint(os, wp.taskIndex);
+                os.put(wp.demand == Demand::PICKUP ? 'p' : 'd');
+                writeVarint(os, wp.getArrivalTime());
+            }
+
+            const auto& assignedTasks = status.getAssignedTasks(k);
+            writeVarint(os, assignedTasks.size());
+            for(auto taskId : assignedTasks){
+                writeVarint(os, taskId);
+            }
+        }
+
+        writeVarint(os, pendingTasks.size());
+        for(auto taskId : pendingTasks){
+            writeVarint(os, taskId);
+        }
+
+        if(!os.flush()){
+            throw std::runtime_error("Cannot write checkpoint " + tmpFile.string());
+        }
+    }
+
+    std::filesystem::rename(tmpFile, file);
+}
+
+std::vector<int> loadCheckpoint(const std::filesystem::path &file, const std::vector<AgentInfo> &agents,
+                                Status &status) {
+    std::ifstream is(file, std::ios::binary);
+    if(!is){
+        throw std::runtime_error("Cannot open checkpoint " + file.string());
+    }
+
+    char header[sizeof(magic)];
+    if(!is.read(header, sizeof(header)) || !std::equal(std::begin(header), std::end(header), std::begin(magic))){
+        throw std::runtime_error(file.string() + " is not a checkpoint");
+    }
+
+    const auto nAgents = status.getPaths().size();
+    const auto nTasks = status.getTasks().size();
+    assert(agents.size() == nAgents);
+    if(readVarint(is) != nAgents || readVarint(is) != nTasks || readVarint(is) != fingerprint(status, agents)){
+        throw std::runtime_error("Checkpoint " + file.string() + " belongs to another instance");
+    }
+
+    // every path step takes at least a byte, so longer paths cannot be in the file
+    const auto fileSize = std::filesystem::file_size(file);
+
+    // read everything before touching status, a corrupted file leaves it untouched
+    std::vector<Path> paths(nAgents);
+    std::vector<WaypointsList> waypoints(nAgents);
+    std::vector<std::vector<int>> assignedTasks(nAgents);
+    std::vector<int> taskAgents(nTasks, -1);
+
+    for(int k = 0 ; k < nAgents ; ++k){
+        paths[k].resize(readBounded(is, fileSize - static_cast<std::size_t>(is.tellg()) + 1));
+        CompressedCoord previous = 0;
+        for(auto& c : paths[k]){
+            c = static_cast<CompressedCoord>(previous + readSigned(is));
+            previous = c;
+        }
+        checkPath(paths[k], agents[k], status);
+
+        auto nWaypoints = readBounded(is, 2 * nTasks + 1);
+        TimeStep cumulatedDelay = 0;
+        TimeStep previousArrival = 0;
+        for(int i = 0 ; i < nWaypoints ; ++i){
+            const auto& task = status.getTask(readBounded(is, nTasks));
+            auto demand = is.get();
+            if(demand != 'p' && demand != 'd'){
+                throw std::runtime_error("Corrupted checkpoint");
+            }
+            auto& wp = waypoints[k].emplace_back(
+                demand == 'p' ? getTaskPickupWaypoint(task) : getTaskDeliveryWaypoint(task)
+            );
+            // checkpoints are restored before executing any step, so arrival times are path indices
+            auto arrivalTime = readBounded(is, paths[k].size());
+            if(arrivalTime < previousArrival || paths[k][arrivalTime] != wp.position){
+                throw std::runtime_error("Checkpoint path of agent " + std::to_string(k) + " misses its waypoints");
+            }
+            previousArrival = arrivalTime;
+            cumulatedDelay = wp.update(arrivalTime, status.getTasks(), cumulatedDelay);
+        }
+
+        assignedTasks[k].resize(readBounded(is, nTasks + 1));
+        for(auto& taskId : assignedTasks[k]){
+            taskId = readBounded(is, nTasks);
+            if(taskAgents[taskId] != -1){
+                throw std::runtime_error("Checkpoint task " + std::to_string(taskId) + " is assigned twice");
+            }
+            taskAgents[taskId] = k;
+        }
+        for(const auto& wp : waypoints[k]){
+            if(taskAgents[wp.taskIndex] != k){
+                throw std::runtime_error(
+                    "Checkpoint waypoint of task " + std::to_string(wp.taskIndex) + " is not in the tasks of agent " +
+                    std::to_string(k)
+                );
+            }
+        }
+    }
+
+    std::vector<int> pendingTasks(readBounded(is, nTasks + 1));
+    for(auto& taskId : pendingTasks){
+        taskId = readBounded(is, nTasks);
+        if(taskAgents[taskId] != -1){
+            throw std::runtime_error("Checkpoint task " + std::to_string(taskId) + " is both assigned and pending");
+        }
+        // pending tasks are marked as assigned to nAgents, to find the ones repeated or missing
+        taskAgents[taskId] = static_cast<int>(nAgents);
+    }
+    if(std::ranges::find(taskAgents, -1) != taskAgents.end()){
+        throw std::runtime_error("Checkpoint tasks are neither assigned nor pending");
+    }
+
+    // conflicts are checked on a copy, which is cheap
+    Status restored{status};
+    for(int k = 0 ; k < nAgents ; ++k){
+        restored.updatePaths(std::move(paths[k]), std::move(waypoints[k]), k);
+        restored.setAssignedTasks(k, std::move(assignedTasks[k]));
+    }
+    if(restored.checkAllConflicts()){
+        throw std::runtime_error("Checkpoint " + file.string() + " has conflicting paths");
+    }
+    status = std::move(restored);
+
+    return pendingTasks;
+}
@@ -0,0 +1,48 @@
+#include <string>
+#include "CommandLine.hpp"
+
+namespace po = boost::program_options;
+
+po::options_description solverOptionsDescription(int defaultThreads) {
+    po::options_description desc("Solver settings");
+    desc.add_options()
+        ("heuristic", po::value<std::string>()->default_value("MCA"), "insertion heuristic: MCA, RMCA_A or RMCA_R")
+        ("batch", po::value<int>()->default_value(1),
+            "max number of non conflicting tasks fixed by each iteration before updating the heaps")
+        ("window", po::value<int>()->default_value(0),
+            "resolve conflicts only in the next W time steps, executing the plan with periodic repairs (0 to disable)")
+        ("replan-every", po::value<int>()->default_value(0),
+            "time steps executed between two repairs of the conflict window, at most W (0 for W)")
+        ("threads", po::value<int>()->default_value(defaultThreads), "number of threads used to update the heaps")
+        ("lazy", po::bool_switch()->default_value(false),
+            "update heaps lazily, recomputing assignments only when they reach the top")
+        ("compact", po::bool_switch()->default_value(false),
+            "store heap paths compressed, decoding them only when extracted")
+    ;
+    return desc;
+}
+
+SolverOptions parseSolverOptions(const po::variables_map &vm) {
+    auto heuristic{heuristics::fromString(vm["heuristic"].as<std::string>())};
+    if(!heuristic){
+        throw po::validation_error(po::validation_error::invalid_option_value, "heuristic", vm["heuristic"].as<std::string>());
+    }
+    auto conflictWindow{vm["window"].as<int>()};
+    if(conflictWindow < 0){
+        throw po::validation_error(po::validation_error::invalid_option_value, "window", std::to_string(conflictWindow));
+    }
+    auto replanPeriod{vm["replan-every"].as<int>()};
+    if(replanPeriod < 0 || (conflictWindow > 0 && replanPeriod > conflictWindow)){
+        throw po::validation_error(po::validation_error::invalid_option_value, "replan-every", std::to_string(replanPeriod));
+    }
+
+    return {
+        .heuristic = *heuristic,
+        .nThreads = vm["threads"].as<int>(),
+        .lazyUpdates = vm["lazy"].as<bool>(),
+        .compactEntries = vm["compact"].as<bool>(),
+        .batchSize = vm["batch"].as<int>(),
+        .conflictWindow = conflictWindow,
+        .replanPeriod = replanPeriod
+    };
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include "CompactPath.hpp"
+#include "AmbientMap.hpp"
+
+namespace {
+    int directionOffset(int directionIndex, int nCols){
+        const auto& d = AmbientMap::directionVector[directionIndex];
+        return d.row * nCols + d.col;
+    }
+}
+
+CompactPath::CompactPath(const Path &path, int nCols) :
+    first{path.empty() ? 0 : path.front()},
+    length{static_cast<int>(path.size())},
+    nCols{nCols}
+    {
+        // most of the moves need a single nibble
+        codes.reserve((path.size() + 1) / 2);
+
+        int nibbleIndex = 0;
+        for(int t = 1 ; t < length ; ++t){
+            auto offset = path[t] - path[t-1];
+
+            int directionIndex = 0;
+            while(directionIndex < AmbientMap::nDirections && directionOffset(directionIndex, nCols) != offset){
+                ++directionIndex;
+            }
+
+            if(directionIndex < AmbientMap::nDirections){
+                pushCode(directionIndex, nibbleIndex);
+                continue;
+            }
+
+            // not a grid movement, store raw coordinate
+            pushCode(escapeCode, nibbleIndex);
+            auto raw = static_cast<std::uint32_t>(path[t]);
+            for(int i = 0 ; i < 8 ; ++i){
+                pushCode((raw >> (4 * i)) & 0xF, nibbleIndex);
+            }
+        }
+        codes.shrink_to_fit();
+    }
+
+void CompactPath::pushCode(std::uint8_t code, int &nibbleIndex) {
+    if(nibbleIndex % 2 == 0){
+        codes.push_back(code);
+    }
+    else{
+        codes.back() |= code << 4;
+    }
+    ++nibbleIndex;
+}
+
+std::uint8_t CompactPath::getCode(int nibbleIndex) const {
+    return (codes[nibbleIndex / 2] >> (4 * (nibbleIndex % 2))) & 0xF;
+}
+
+Path CompactPath::decode() const {
+    Path path;
+    decode(path);
+    return path;
+}
+
+void CompactPath::decode(Path &out) const {
+    out.clear();
+    if(length == 0){
+        return;
+    }
+    out.reserve(length);
+    out.push_back(first);
+
+    int nibbleIndex = 0;
+    while(out.size() < length){
+        auto code = getCode(nibbleIndex++);
+
+        if(code != escapeCode){
+            assert(code < AmbientMap::nDirections);
+            out.push_back(out.back() + directionOffset(code, nCols));
+            continue;
+        }
+
+        std::uint32_t raw = 0;
+        for(int i = 0 ; i < 8 ; ++i){
+            raw |= static_cast<std::uint32_t>(getCode(nibbleIndex++)) << (4 * i);
+        }
+        out.push_back(static_cast<CompressedCoord>(raw));
+    }
+}
+
+int CompactPath::size() const {
+    return length;
+}
+
+bool CompactPath::empty() const {
+    return length == 0;
+}
+
+std::size_t CompactPath::getMemoryUsage() const {
+    return codes.capacity() * sizeof(std::uint8_t);
+}
@@ -3,14 +3,34 @@
 #include "DistanceMatrix.hpp"
 #include "Coord.hpp"
 
+namespace {
+    DistanceMatrix loadDistances(const std::filesystem::path &data){
+        auto array = std::make_shared<const cnpy::NpyArray>(cnpy::npy_load(data));
+        const auto& shape = array->shape;
+        if(shape.size() != 4 || shape[0] * shape[1] != shape[2] * shape[3] || array->word_size != sizeof(double)){
+            throw std::runtime_error("Loaded wrong distance matrix");
+        }
+        // the array owns the buffer
+        return {
+            std::shared_ptr<const double>{array, array->data<double>()},
+            static_cast<int>(shape[0]),
+            static_cast<int>(shape[1])
+        };
+    }
+}
+
 DistanceMatrix::DistanceMatrix(const std::filesystem::path& data) :
-    rawDistanceMatrix{cnpy::npy_load(data)},
-    nRows{static_cast<int>(rawDistanceMatrix.shape[0])},
-    nCols{static_cast<int>(rawDistanceMatrix.shape[1])},
-    startCoordsSize{static_cast<int>(rawDistanceMatrix.shape[0] * rawDistanceMatrix.shape[1])},
-    endCoordsSize{static_cast<int>(rawDistanceMatrix.shape[2] * rawDistanceMatrix.shape[3])}
+    DistanceMatrix{loadDistances(data)}
+    {}
+
+DistanceMatrix::DistanceMatrix(std::shared_ptr<const double> distances, int nRows, int nCols) :
+    nRows{nRows},
+    nCols{nCols},
+    startCoordsSize{nRows * nCols},
+    endCoordsSize{nRows * nCols},
+    distances{std::move(distances)}
     {
-        if(startCoordsSize != endCoordsSize || rawDistanceMatrix.shape.size() != 4){
+        if(!this->distances || nRows <= 0 || nCols <= 0){
             throw std::runtime_error("Loaded wrong distance matrix");
         }
     }
@@ -24,9 +44,7 @@ CompressedCoord DistanceMatrix::from2Dto1D(int row, int col) const{
 }
 
 int DistanceMatrix::getDistance(CompressedCoord from, CompressedCoord to) const {
-    // distance matrix is considered double
-    const auto* ptr = rawDistanceMatrix.data<double>();
-    return static_cast<int>(ptr[from * endCoordsSize + to]);
+    return static_cast<int>(distances.get()[static_cast<std::size_t>(from) * endCoordsSize + to]);
 }
 
 CompressedCoord DistanceMatrix::from2Dto1D(const Coord &point) const{
@@ -36,3 +54,7 @@ CompressedCoord DistanceMatrix::from2Dto1D(const Coord &point) const{
 Coord DistanceMatrix::from1Dto2D(CompressedCoord point) const {
     return {point / nCols, point % nCols};
 }
+
+std::size_t DistanceMatrix::getMemoryUsage() const {
+    return static_cast<std::size_t>(startCoordsSize) * endCoordsSize * sizeof(double);
+}
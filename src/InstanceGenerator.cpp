@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <cnpy.h>
+#include "InstanceGenerator.hpp"
+#include "AmbientMap.hpp"
+
+namespace generator {
+
+    namespace {
+        constexpr double unreachable = 1e9;
+
+        std::vector<Coord> cellsOfType(const Grid &grid, CellType type){
+            std::vector<Coord> cells;
+            for(int r = 0 ; r < grid.size() ; ++r){
+                for(int c = 0 ; c < grid[r].size() ; ++c){
+                    if(grid[r][c] == static_cast<char>(type)){
+                        cells.push_back({r, c});
+                    }
+                }
+            }
+            return cells;
+        }
+
+        // k distinct elements drawn with probability proportional to weights (Efraimidis-Spirakis)
+        std::vector<int> weightedSample(const std::vector<double> &weights, int k, std::mt19937 &gen){
+            std::uniform_real_distribution<double> unitDist{0., 1.};
+            std::vector<std::pair<double, int>> keys;
+            keys.reserve(weights.size());
+            for(int i = 0 ; i < weights.size() ; ++i){
+                keys.emplace_back(std::log(unitDist(gen)) / weights[i], i);
+            }
+            std::partial_sort(keys.begin(), keys.begin() + k, keys.end(), std::greater<>{});
+
+            std::vector<int> sample;
+            sample.reserve(k);
+            for(int i = 0 ; i < k ; ++i){
+                sample.push_back(keys[i].second);
+            }
+            return sample;
+        }
+
+        std::ofstream openOutput(const std::filesystem::path &file){
+            std::ofstream fs(file, std::ios::out | std::ios::trunc);
+            if(!fs){
+                throw std::runtime_error("Cannot write " + file.string());
+            }
+            return fs;
+        }
+    }
+
+    Grid warehouseGrid(const WarehouseLayout &layout) {
+        if(layout.nBlockRows <= 0 || layout.nBlockCols <= 0 || layout.shelfLength <= 0 || layout.aisleWidth <= 0){
+            throw std::invalid_argument("Warehouse sizes must be positive");
+        }
+
+        const auto aisle = std::string(layout.aisleWidth, static_cast<char>(CellType::FLOOR));
+        auto blockRow = [&](CellType shelfCell){
+            auto row = aisle;
+            for(int b = 0 ; b < layout.nBlockCols ; ++b){
+                row += std::string(layout.shelfLength, static_cast<char>(shelfCell)) + aisle;
+            }
+            return row;
+        };
+
+        const auto aisleRow = blockRow(CellType::FLOOR);
+        Grid grid(layout.aisleWidth, aisleRow);
+        for(int b = 0 ; b < layout.nBlockRows ; ++b){
+            grid.push_back(blockRow(CellType::ENDPOINT));
+            grid.push_back(blockRow(CellType::OBSTACLE));
+            grid.push_back(blockRow(CellType::ENDPOINT));
+            grid.insert(grid.end(), layout.aisleWidth, aisleRow);
+        }
+        return grid;
+    }
+
+    Grid loadGrid(const std::filesystem::path &gridFile) {
+        std::ifstream fs(gridFile);
+        if(!fs){
+            throw std::runtime_error("Cannot open " + gridFile.string());
+        }
+
+        Grid grid;
+        for(std::string line ; std::getline(fs, line) ; ){
+            if(!line.empty()){
+                grid.push_back(line);
+            }
+        }
+        return grid;
+    }
+
+    std::vector<double> distanceMatrix(const Grid &grid) {
+        const auto nRows = static_cast<int>(grid.size());
+        const auto nCols = static_cast<int>(grid.front().size());
+        const auto nCells = nRows * nCols;
+        auto isFree = [&](int r, int c){
+            return r >= 0 && r < nRows && c >= 0 && c < nCols && grid[r][c] != static_cast<char>(CellType::OBSTACLE);
+        };
+
+        std::vector<double> distances(static_cast<std::size_t>(nCells) * nCells, unreachable);
+        std::deque<int> frontier;
+        for(int source = 0 ; source < nCells ; ++source){
+            if(!isFree(source / nCols, source % nCols)){
+                continue;
+            }
+            auto* row = distances.data() + static_cast<std::size_t>(source) * nCells;
+            row[source] = 0;
+
+            frontier.push_back(source);
+            while(!frontier.empty()){
+                auto u = frontier.front();
+                frontier.pop_front();
+                for(const auto& d : AmbientMap::directionVector){
+                    auto r = u / nCols + d.row;
+                    auto c = u % nCols + d.col;
+                    if(isFree(r, c) && row[r * nCols + c] > row[u] + 1){
+                        row[r * nCols + c] = row[u] + 1;
+                        frontier.push_back(r * nCols + c);
+                    }
+                }
+            }
+        }
+        return distances;
+    }
+
+    std::vector<GeneratedTask> randomTasks(const Grid &grid, int nTasks, double skew, TimeStep horizon,
+                                           std::mt19937 &gen) {
+        auto endpoints = cellsOfType(grid, CellType::ENDPOINT);
+        if(2 * nTasks > endpoints.size()){
+            throw std::invalid_argument("Not enough endpoints for " + std::to_string(nTasks) + " tasks");
+        }
+
+        // hot zone in the top left corner
+        std::ranges::stable_sort(endpoints, {}, [](const Coord &c){ return c.row + c.col; });
+        std::vector<double> weights(endpoints.size());
+        for(int rank = 0 ; rank < weights.size() ; ++rank){
+            weights[rank] = 1. / std::pow(rank + 1, skew);
+        }
+        auto pickups = weightedSample(weights, nTasks, gen);
+
+        std::vector<bool> isPickup(endpoints.size(), false);
+        for(auto i : pickups){
+            isPickup[i] = true;
+        }
+        std::vector<int> others;
+        for(int i = 0 ; i < endpoints.size() ; ++i){
+            if(!isPickup[i]){
+                others.push_back(i);
+            }
+        }
+        std::shuffle(others.begin(), others.end(), gen);
+
+        std::uniform_int_distribution<TimeStep> releaseDist{0, std::max(horizon - 1, 0)};
+        std::vector<GeneratedTask> tasks;
+        tasks.reserve(nTasks);
+        for(int i = 0 ; i < nTasks ; ++i){
+            tasks.push_back({endpoints[pickups[i]], endpoints[others[i]], horizon > 0 ? releaseDist(gen) : 0});
+        }
+        // streamed tasks must be sorted by release time
+        std::ranges::stable_sort(tasks, {}, &GeneratedTask::releaseTime);
+        return tasks;
+    }
+
+    std::vector<Coord> randomAgents(const Grid &grid, int nAgents, const std::vector<GeneratedTask> &tasks,
+                                    std::mt19937 &gen) {
+        auto isTaskEndpoint = [&](const Coord &c){
+            return std::ranges::any_of(tasks, [&](const GeneratedTask &t){ return t.start == c || t.goal == c; });
+        };
+        auto cells = cellsOfType(grid, CellType::ENDPOINT);
+        std::erase_if(cells, isTaskEndpoint);
+
+        if(nAgents > cells.size()){
+            throw std::invalid_argument("Not enough free endpoints for " + std::to_string(nAgents) + " agents");
+        }
+        std::shuffle(cells.begin(), cells.end(), gen);
+        cells.resize(nAgents);
+        return cells;
+    }
+
+    void saveGrid(const std::filesystem::path &file, const Grid &grid) {
+        auto fs = openOutput(file);
+        for(const auto& row : grid){
+            fs << row << '\n';
+        }
+    }
+
+    void saveDistanceMatrix(const std::filesystem::path &file, const Grid &grid) {
+        auto distances = distanceMatrix(grid);
+        auto nRows = grid.size();
+        auto nCols = grid.front().size();
+        cnpy::npy_save(file.string(), distances.data(), {nRows, nCols, nRows, nCols}, "w");
+    }
+
+    void saveAgents(const std::filesystem::path &file, const std::vector<Coord> &agents) {
+        auto fs = openOutput(file);
+        fs << agents.size() << '\n';
+        for(const auto& a : agents){
+            fs << a.row << ',' << a.col << '\n';
+        }
+    }
+
+    void saveTasks(const std::filesystem::path &file, const std::vector<GeneratedTask> &tasks) {
+        const bool withRelease = std::ranges::any_of(tasks, [](const GeneratedTask &t){ return t.releaseTime > 0; });
+
+        auto fs = openOutput(file);
+        fs << tasks.size() << '\n';
+        for(const auto& t : tasks){
+            fs << t.start.row << ',' << t.start.col << ',' << t.goal.row << ',' << t.goal.col;
+            if(withRelease){
+                fs << ',' << t.releaseTime;
+            }
+            fs << '\n';
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include "LNS.hpp"
+#include "BigH.hpp"
+
+TimeStep Solution::getTotalDelay() const {
+    return std::accumulate(agentsTTD.begin(), agentsTTD.end(), TimeStep{0});
+}
+
+LNS::LNS(const std::vector<AgentInfo> &agents, Heuristic heuristic, int neighborhoodSize, bool lazy,
+         ThreadPool &pool) :
+    agents{agents},
+    heuristic{heuristic},
+    neighborhoodSize{neighborhoodSize},
+    lazy{lazy},
+    pool{pool}
+    {}
+
+int LNS::run(Solution &solution, std::chrono::steady_clock::time_point deadline) {
+    const int nWorkers = pool.size();
+    int accepted = 0;
+
+    for(int round = 0 ; std::chrono::steady_clock::now() < deadline ; ++round){
+        std::vector<std::optional<Solution>> candidates(nWorkers);
+        const auto actualDelay = solution.getTotalDelay();
+
+        // solution is only read by the workers
+        pool.parallelFor(nWorkers, [&](int i){
+            auto iteration = round * nWorkers + i;
+
+            // seeded by iteration, so that results only depend on the number of threads
+            std::mt19937 gen{static_cast<std::mt19937::result_type>(iteration)};
+            auto neighborhood = static_cast<Neighborhood>(iteration % nNeighborhoods);
+
+            auto taskIds = selectTasks(neighborhood, solution, gen);
+            if(taskIds.empty()){
+                return;
+            }
+
+            try{
+                auto candidate = destroyAndRepair(solution, taskIds);
+                if(candidate.getTotalDelay() < actualDelay && !candidate.status.checkAllConflicts()){
+                    candidates[i] = std::move(candidate);
+                }
+            }
+            // some agent has no path in the candidate plan, discard it
+            catch(const std::runtime_error&){}
+        });
+
+        std::optional<Solution>* best = nullptr;
+        for(auto& candidate : candidates){
+            if(candidate && (best == nullptr || candidate->getTotalDelay() < (*best)->getTotalDelay())){
+                best = &candidate;
+            }
+        }
+
+        if(best != nullptr){
+            solution = std::move(best->value());
+            ++accepted;
+        }
+    }
+
+    return accepted;
+}
+
+std::vector<int> LNS::selectTasks(Neighborhood neighborhood, const Solution &solution, std::mt19937 &gen) const {
+    const auto& status = solution.status;
+    const auto& tasks = status.getTasks();
+    const auto size = std::min(neighborhoodSize, static_cast<int>(tasks.size()));
+
+    if(size == 0){
+        return {};
+    }
+
+    std::vector<int> taskIds(tasks.size());
+    std::iota(taskIds.begin(), taskIds.end(), 0);
+
+    switch(neighborhood){
+        case Neighborhood::SPATIAL: {
+            const auto& dm = status.getDistanceMatrix();
+            auto center = tasks[std::uniform_int_distribution<int>{0, static_cast<int>(tasks.size()) - 1}(gen)].startLoc;
+
+            std::ranges::partial_sort(taskIds, taskIds.begin() + size, {},
+                                      [&](int taskId){ return dm.getDistance(center, tasks[taskId].startLoc); });
+            taskIds.resize(size);
+            break;
+        }
+        case Neighborhood::WORST_AGENTS: {
+            std::vector<int> agentIds(agents.size());
+            std::iota(agentIds.begin(), agentIds.end(), 0);
+            std::ranges::stable_sort(agentIds, std::greater<>{}, [&](int k){ return solution.agentsTTD[k]; });
+
+            // start from one of the worst agents, so that rounds do not always pick the same tasks
+            auto firstAgent = std::uniform_int_distribution<int>{0, static_cast<int>(agentIds.size()) / 4}(gen);
+
+            taskIds.clear();
+            for(int i = firstAgent ; i < agentIds.size() && taskIds.size() < size ; ++i){
+                for(int taskId : status.getAssignedTasks(agentIds[i])){
+                    if(taskIds.size() < size){
+                        taskIds.push_back(taskId);
+                    }
+                }
+            }
+            break;
+        }
+        // RANDOM
+        default:
+            std::ranges::shuffle(taskIds, gen);
+            taskIds.resize(size);
+            break;
+    }
+
+    return taskIds;
+}
+
+Solution LNS::destroyAndRepair(const Solution &solution, const std::vector<int> &taskIds) const {
+    auto candidate{solution};
+    removeTasks(candidate, taskIds);
+
+    switch(heuristic){
+        case Heuristic::RMCA_A:
+            reinsertTasks<heuristics::RMCA_A>(candidate, taskIds);
+            break;
+        case Heuristic::RMCA_R:
+            reinsertTasks<heuristics::RMCA_R>(candidate, taskIds);
+            break;
+        // MCA
+        default:
+            reinsertTasks<heuristics::MCA>(candidate, taskIds);
+            break;
+    }
+
+    return candidate;
+}
+
+void LNS::removeTasks(Solution &solution, const std::vector<int> &taskIds) const {
+    auto& status = solution.status;
+    // plans are rebuilt from scratch, so there must be no task already picked up
+    assert(status.getElapsedTime() == 0);
+
+    for(int k = 0 ; k < agents.size() ; ++k){
+        auto remainingTasks = status.getAssignedTasks(k);
+        auto removed = std::erase_if(remainingTasks, [&](int taskId){ return std::ranges::find(taskIds, taskId) != taskIds.end(); });
+        if(removed == 0){
+            continue;
+        }
+
+        // own path is ignored by the planner, so the new plan only has to avoid the other agents
+        Assignment assignment{agents[k]};
+        for(int taskId : remainingTasks){
+            assignment.addTask(taskId, status);
+        }
+
+        auto pathWrapper = assignment.extractAndReset();
+        solution.agentsTTD[k] = pathWrapper.ttd;
+        status.updatePaths(std::move(pathWrapper.path), std::move(pathWrapper.waypoints), k);
+        status.setAssignedTasks(k, std::move(remainingTasks));
+    }
+}
+
+template<typename HeuristicPolicy>
+void LNS::reinsertTasks(Solution &solution, const std::vector<int> &taskIds) const {
+    auto& status = solution.status;
+
+    // workers already run in parallel, every candidate is built serially
+    ThreadPool serial{1};
+    BigH<HeuristicPolicy> bigH{agents, status, taskIds, lazy, false, serial};
+
+    while(!bigH.empty()){
+        auto [taskId, pathWrapper] = bigH.extractTop(status);
+        auto k = pathWrapper.agentId;
+
+        solution.agentsTTD[k] = pathWrapper.ttd;
+        status.updatePaths(std::move(pathWrapper.path), std::move(pathWrapper.waypoints), k);
+        status.assignTask(taskId, k);
+        bigH.update(k, taskId, status);
+    }
+}
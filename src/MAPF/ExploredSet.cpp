@@ -5,7 +5,9 @@
 #include "MAPF/ExploredSet.hpp"
 
 void ExploredSet::add(const Node& node){
-    exploredSet[node.getLocation()].insert(node.getGScore());
+    if(exploredSet[node.getLocation()].insert(node.getGScore()).second){
+        ++nStates;
+    }
 }
 
 bool ExploredSet::contains(CompressedCoord loc, TimeStep t) const{
@@ -14,4 +16,12 @@ bool ExploredSet::contains(CompressedCoord loc, TimeStep t) const{
 
 void ExploredSet::clear() {
     exploredSet.clear();
+    nStates = 0;
+}
+
+std::size_t ExploredSet::getMemoryUsage() const {
+    // hash nodes hold the value, the next pointer and the cached hash, bucket arrays are ignored
+    constexpr auto nodeOverhead = 2 * sizeof(void*);
+    return exploredSet.size() * (sizeof(decltype(exploredSet)::value_type) + nodeOverhead) +
+        nStates * (sizeof(TimeStep) + nodeOverhead);
 }
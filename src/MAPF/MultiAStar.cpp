@@ -2,10 +2,21 @@
 // Created by nicco on 03/01/2023.
 //
 
+#include <algorithm>
+#include <atomic>
 #include "MAPF/MultiAStar.hpp"
+#include "Profiling.hpp"
+#include "Trace.hpp"
+
+namespace {
+    std::atomic<std::size_t> peakSearchMemory{0};
+}
 
 std::pair<Path, WaypointsList>
-MultiAStar::solve(WaypointsList &&waypoints, CompressedCoord agentLoc, const Status &status, int agentId) {
+MultiAStar::solve(WaypointsList &&waypoints, CompressedCoord agentLoc, const Status &status, int agentId,
+                  TimeStep startTime) {
+    profiling::count(profiling::Counter::A_STAR_CALLS);
+    profiling::TraceScope trace{"MultiAStar::solve", agentId};
     if(waypoints.empty()){
         return {{agentLoc}, waypoints};
     }
@@ -18,43 +29,73 @@ MultiAStar::solve(WaypointsList &&waypoints, CompressedCoord agentLoc, const Sta
 
     const auto& distanceMatrix = status.getDistanceMatrix();
 
-    TimeStep t = 0;
+    TimeStep t = startTime;
+
+    // after the end of the other paths (or of the conflict window) the map is static,
+    // so a reachable goal needs at most nCells more steps
+    TimeStep othersEnd = 0;
+    for(int i = 0 ; i < status.getPaths().size() ; ++i){
+        if(i != agentId){
+            othersEnd = std::max(othersEnd, static_cast<TimeStep>(status.getPaths()[i].size()));
+        }
+    }
+    if(status.getConflictWindow() > 0){
+        othersEnd = std::min(othersEnd, status.getConflictWindow() + 1);
+    }
+    const auto nCells = distanceMatrix.nRows * distanceMatrix.nCols;
 
-    // todo fix possible loop
-    for(auto & w : waypoints){
+    for(auto wpIt = waypoints.begin() ; wpIt != waypoints.end() ; ++wpIt){
+        auto& w = *wpIt;
         auto goalLoc = w.position;
+        // a task cannot be picked up before its release, relative to the actual time as t
+        auto earliestArrival = w.demand == Demand::PICKUP ?
+            status.getTask(w.taskIndex).releaseTime - status.getElapsedTime() : 0;
+        horizon = std::max({othersEnd, t, earliestArrival}) + nCells;
 
-        frontier.emplace(new Node{actualLoc, t, distanceMatrix.getDistance(actualLoc, goalLoc)});
-        t = fillPath(status, agentId, goalLoc, pathList);
-        assert(!status.checkPathWithStatus({pathList.begin(), pathList.end()}, agentId));
+        frontier.emplace(new Node{actualLoc, t, std::max(distanceMatrix.getDistance(actualLoc, goalLoc), earliestArrival - t)});
+        nNodes = 1;
+        t = fillPath(status, agentId, goalLoc, earliestArrival, std::next(wpIt) == waypoints.end(), pathList);
 
+        updatePeakMemoryUsage();
         frontier.clear();
         exploredSet.clear();
 
         // old goal is new start position
         actualLoc = goalLoc;
-        cumulatedDelay = w.update(t, status.getTasks(), cumulatedDelay);
+        // arrival times are absolute, t is relative to the actual time
+        cumulatedDelay = w.update(t + status.getElapsedTime(), status.getTasks(), cumulatedDelay);
     }
 
-    return {{pathList.begin(), pathList.end()}, waypoints};
+    // the search starts at startTime, the wait before it is prepended
+    Path path(startTime, agentLoc);
+    path.insert(path.end(), pathList.begin(), pathList.end());
+    // partial paths are not checked, the agent does not stop at intermediate waypoints
+    assert(startTime > 0 || !status.checkPathWithStatus(path, agentId));
+    return {std::move(path), waypoints};
 }
 
-TimeStep MultiAStar::fillPath(const Status &status, int agentId, CompressedCoord goalLoc, std::list<CompressedCoord> &pathList) {
+TimeStep MultiAStar::fillPath(const Status &status, int agentId, CompressedCoord goalLoc, TimeStep earliestArrival,
+                              bool finalGoal, std::list<CompressedCoord> &pathList) {
     while (!frontier.empty()){
         auto topNodePtr = *frontier.cbegin();
         frontier.erase(frontier.cbegin());
 
-        if(topNodePtr->getLocation() == goalLoc){
+        // the agent stays in its final goal, so no other agent may pass there later
+        if(topNodePtr->getLocation() == goalLoc && topNodePtr->getGScore() >= earliestArrival &&
+            (!finalGoal || !status.checkFinalPosition(agentId, goalLoc, topNodePtr->getGScore()))){
             auto partialPathList = topNodePtr->getPathList();
-            // merge (without std::prev there would be duplicates)
-            auto attachIt = pathList.empty() ? pathList.cend() :  std::prev(pathList.cend());
-            pathList.splice(attachIt, partialPathList);
+            // the partial path starts from the previous goal, already at the end of pathList
+            if(!pathList.empty()){
+                partialPathList.pop_front();
+            }
+            pathList.splice(pathList.cend(), partialPathList);
             return topNodePtr->getGScore();
         }
 
+        profiling::count(profiling::Counter::NODE_EXPANSIONS);
         auto neighbors = status.getValidNeighbors(agentId, topNodePtr->getLocation(), topNodePtr->getGScore());
 
-        updateFrontier(topNodePtr, neighbors, status.getDistanceMatrix(), goalLoc);
+        updateFrontier(topNodePtr, neighbors, status.getDistanceMatrix(), goalLoc, earliestArrival);
 
         exploredSet.add(*topNodePtr);
     }
@@ -63,11 +104,29 @@ TimeStep MultiAStar::fillPath(const Status &status, int agentId, CompressedCoord
 
 void
 MultiAStar::updateFrontier(const std::shared_ptr<Node>& parentPtr, const std::vector<CompressedCoord> &neighbors, const DistanceMatrix &dm,
-                           CompressedCoord targetPos) {
+                           CompressedCoord targetPos, TimeStep earliestArrival) {
     auto newT = parentPtr->getGScore() + 1;
+    if(newT > horizon){
+        return;
+    }
     for(auto loc : neighbors){
         if(!exploredSet.contains(loc, newT)){
-            frontier.emplace(new Node{loc, newT, dm.getDistance(loc, targetPos), parentPtr});
+            // waiting for the release is part of the remaining cost
+            frontier.emplace(new Node{loc, newT, std::max(dm.getDistance(loc, targetPos), earliestArrival - newT), parentPtr});
+            ++nNodes;
         }
     }
 }
+
+void MultiAStar::updatePeakMemoryUsage() const {
+    // node, shared_ptr control block and frontier tree node
+    constexpr auto nodeBytes = sizeof(Node) + sizeof(std::shared_ptr<Node>) + 6 * sizeof(void*);
+    auto bytes = nNodes * nodeBytes + exploredSet.getMemoryUsage();
+
+    auto peak = peakSearchMemory.load(std::memory_order_relaxed);
+    while(bytes > peak && !peakSearchMemory.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)){}
+}
+
+std::size_t MultiAStar::getPeakMemoryUsage() {
+    return peakSearchMemory.load(std::memory_order_relaxed);
+}
@@ -3,6 +3,7 @@
 //
 
 #include <list>
+#include <tuple>
 #include <utility>
 #include "MAPF/Node.hpp"
 
@@ -32,7 +33,8 @@ std::list<CompressedCoord> Node::getPathList() const {
 }
 
 bool operator<(const Node &a, const Node &b) {
-    return a.getFScore() < b.getFScore();
+    // the frontier is a set, so ties must be broken down to the state (location, time), deeper nodes first
+    return std::tuple{a.getFScore(), -a.g, a.location} < std::tuple{b.getFScore(), -b.g, b.location};
 }
 
 CompressedCoord Node::getLocation() const {
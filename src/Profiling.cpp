@@ -0,0 +1,234 @@
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <string_view>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fmt/ostream.h>
+#include "Profiling.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace profiling {
+
+    namespace {
+        struct PhaseStats{
+            long long calls = 0;
+            std::chrono::steady_clock::duration total{};
+            std::chrono::steady_clock::duration max{};
+            HardwareCounts hardware{};
+        };
+
+        constexpr int nPhases = static_cast<int>(Phase::N_PHASES);
+        constexpr int nCounters = static_cast<int>(Counter::N_COUNTERS);
+
+        constexpr std::array<std::string_view, nPhases> phaseNames{
+            "load", "big_h_build", "solve_iteration", "validation"
+        };
+        constexpr std::array<std::string_view, nCounters> counterNames{
+            "a_star_calls", "node_expansions", "neighbor_checks", "insertion_candidates", "heap_updates", "replans"
+        };
+        constexpr std::array<std::string_view, nHardwareCounters> hardwareNames{
+            "cycles", "instructions", "cache_misses", "branch_misses"
+        };
+
+        std::mutex registryMutex;
+        // deque keeps the slots in place while new threads are registered
+        std::deque<detail::CounterSlots> threadSlots;
+        std::vector<detail::CounterSlots*> freeSlots;
+        // counts of the threads that exited
+        std::array<long long, nCounters> releasedCounts{};
+        std::array<PhaseStats, nPhases> phases{};
+
+        double toMs(std::chrono::steady_clock::duration d){
+            return std::chrono::duration<double, std::milli>(d).count();
+        }
+
+        // group leader first, one group for each attached thread still running
+        std::mutex hardwareMutex;
+        std::vector<std::array<int, nHardwareCounters>> hardwareGroups;
+        // counts of the groups closed on thread exit
+        HardwareCounts closedCounts{};
+
+#ifdef __linux__
+        void addGroupCounts(const std::array<int, nHardwareCounters> &fds, HardwareCounts &totals){
+            struct {
+                std::uint64_t nr;
+                std::uint64_t timeEnabled;
+                std::uint64_t timeRunning;
+                std::uint64_t values[nHardwareCounters];
+            } data{};
+
+            if(read(fds[0], &data, sizeof(data)) != sizeof(data) || data.timeRunning == 0){
+                return;
+            }
+            // scale the counts if the group was multiplexed with other events
+            auto scale = static_cast<double>(data.timeEnabled) / static_cast<double>(data.timeRunning);
+            for(int i = 0 ; i < nHardwareCounters ; ++i){
+                totals[i] += static_cast<std::uint64_t>(static_cast<double>(data.values[i]) * scale);
+            }
+        }
+
+        // closes the group of its thread on thread exit, keeping its counts in closedCounts
+        struct ThreadGroup{
+            std::array<int, nHardwareCounters> fds{-1, -1, -1, -1};
+
+            ~ThreadGroup(){
+                if(fds[0] < 0){
+                    return;
+                }
+                std::scoped_lock lock{hardwareMutex};
+                addGroupCounts(fds, closedCounts);
+                hardwareGroups.erase(std::find(hardwareGroups.begin(), hardwareGroups.end(), fds));
+                for(auto fd : fds){
+                    close(fd);
+                }
+            }
+        };
+
+        thread_local ThreadGroup threadGroup;
+
+        // opens the group of the calling thread, returns errno on failure
+        int openGroup(){
+            if(threadGroup.fds[0] >= 0){
+                return 0;
+            }
+            constexpr std::array<std::uint64_t, nHardwareCounters> configs{
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+
+            std::array<int, nHardwareCounters> fds{};
+            fds.fill(-1);
+            for(int i = 0 ; i < nHardwareCounters ; ++i){
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = i == 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, fds[0], 0));
+                if(fds[i] < 0){
+                    auto error = errno;
+                    for(int j = 0 ; j < i ; ++j){
+                        close(fds[j]);
+                    }
+                    return error;
+                }
+            }
+            ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+            std::scoped_lock lock{hardwareMutex};
+            hardwareGroups.push_back(fds);
+            threadGroup.fds = fds;
+            return 0;
+        }
+#endif
+    }
+
+    std::atomic<bool> detail::hardwareActive{false};
+
+    std::string startHardwareCounters() {
+        if constexpr(!enabled){
+            return "not a profiling build";
+        }
+#ifdef __linux__
+        if(auto error = openGroup() ; error != 0){
+            return std::strerror(error);
+        }
+        detail::hardwareActive.store(true, std::memory_order_relaxed);
+        return {};
+#else
+        return "perf_event_open is available only on Linux";
+#endif
+    }
+
+    void detail::openThreadCounters() {
+#ifdef __linux__
+        // a thread that cannot open its counters is just not counted
+        openGroup();
+#endif
+    }
+
+    HardwareCounts detail::readHardwareCounters() {
+        HardwareCounts totals{};
+#ifdef __linux__
+        std::scoped_lock lock{hardwareMutex};
+        totals = closedCounts;
+        for(const auto& fds : hardwareGroups){
+            addGroupCounts(fds, totals);
+        }
+#endif
+        return totals;
+    }
+
+    detail::CounterSlots &detail::registerThread() {
+        std::scoped_lock lock{registryMutex};
+        if(freeSlots.empty()){
+            return threadSlots.emplace_back();
+        }
+        auto* slots = freeSlots.back();
+        freeSlots.pop_back();
+        return *slots;
+    }
+
+    void detail::releaseThread(CounterSlots &slots) {
+        std::scoped_lock lock{registryMutex};
+        for(int i = 0 ; i < nCounters ; ++i){
+            releasedCounts[i] += slots.counts[i].exchange(0, std::memory_order_relaxed);
+        }
+        freeSlots.push_back(&slots);
+    }
+
+    void detail::addPhaseTime(Phase phase, std::chrono::steady_clock::duration elapsed, const HardwareCounts *counts) {
+        std::scoped_lock lock{registryMutex};
+        auto& stats = phases[static_cast<int>(phase)];
+        ++stats.calls;
+        stats.total += elapsed;
+        stats.max = std::max(stats.max, elapsed);
+        if(counts){
+            for(int i = 0 ; i < nHardwareCounters ; ++i){
+                stats.hardware[i] += (*counts)[i];
+            }
+        }
+    }
+
+    void writeReport(std::ostream &os) {
+        std::scoped_lock lock{registryMutex};
+
+        auto totals = releasedCounts;
+        for(const auto& slots : threadSlots){
+            for(int i = 0 ; i < nCounters ; ++i){
+                totals[i] += slots.counts[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        fmt::print(os, "{{\n  \"phases\": {{\n");
+        const bool withHardware = detail::hardwareActive.load(std::memory_order_relaxed);
+        for(int i = 0 ; i < nPhases ; ++i){
+            fmt::print(os, "    \"{}\": {{\"calls\": {}, \"total_ms\": {:.3f}, \"max_ms\": {:.3f}",
+                       phaseNames[i], phases[i].calls, toMs(phases[i].total), toMs(phases[i].max));
+            if(withHardware){
+                for(int h = 0 ; h < nHardwareCounters ; ++h){
+                    fmt::print(os, ", \"{}\": {}", hardwareNames[h], phases[i].hardware[h]);
+                }
+            }
+            fmt::print(os, "}}{}\n", i + 1 < nPhases ? "," : "");
+        }
+        fmt::print(os, "  }},\n  \"counters\": {{\n");
+        for(int i = 0 ; i < nCounters ; ++i){
+            fmt::print(os, "    \"{}\": {}{}\n", counterNames[i], totals[i], i + 1 < nCounters ? "," : "");
+        }
+        fmt::print(os, "  }}\n}}\n");
+    }
+}
@@ -1,31 +1,566 @@
 #include <algorithm>
 #include <functional>
+#include <numeric>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include "SCMAPD.hpp"
 #include "Assignment.hpp"
 #include "fmt/color.h"
+#include "fmt/ranges.h"
 #include "BigH.hpp"
+#include "MAPF/MultiAStar.hpp"
+#include "WarmStart.hpp"
+#include "Checkpoint.hpp"
+#include "Profiling.hpp"
+#include "Trace.hpp"
 
 SCMAPD::SCMAPD(AmbientMap&& ambientMap, const std::vector<AgentInfo> &agents,
-               std::vector<Task> &&tasksVector, Heuristic heuristic, bool debug) :
-    status(std::move(ambientMap), agents.size(), std::move(tasksVector)),
-    bigH{agents, status, heuristic},
-    debug{debug}
+               std::vector<Task> &&tasksVector, const SolverOptions &options, bool debug) :
+    SCMAPD(std::make_shared<const AmbientMap>(std::move(ambientMap)), agents, std::move(tasksVector), options, debug)
+    {}
+
+SCMAPD::SCMAPD(std::shared_ptr<const AmbientMap> ambientMap, const std::vector<AgentInfo> &agents,
+               std::vector<Task> &&tasksVector, const SolverOptions &options, bool debug) :
+    status(std::move(ambientMap), agents.size(), std::move(tasksVector), options.conflictWindow),
+    agents{agents},
+    pool{options.nThreads},
+    bigH{makeBigH(
+        options.heuristic, agents, status, seedStatus(status, agents, options),
+        options.lazyUpdates, options.compactEntries, pool
+    )},
+    debug{debug},
+    heuristic{options.heuristic},
+    lazyUpdates{options.lazyUpdates},
+    lnsNeighborhoodSize{options.lnsNeighborhoodSize},
+    batchSize{options.batchSize},
+    replanPeriod{options.replanPeriod > 0 ? options.replanPeriod : options.conflictWindow},
+    checkpointFile{options.checkpointFile},
+    checkpointInterval{options.checkpointFile.empty() ? 0 : options.checkpointInterval},
+    agentsTTD(agents.size(), 0),
+    stoppedAgents(agents.size(), false),
+    waitingWaypoints(agents.size()),
+    compactEntries{options.compactEntries},
+    memoryReport{options.memoryReport},
+    memoryReportInterval{options.memoryReportInterval}
     {
         assert(!status.checkAllConflicts());
+        syncAgentsWithStatus();
+        // steps beyond the window are not checked, so they must not be executed before a repair
+        assert(options.conflictWindow == 0 || replanPeriod <= options.conflictWindow);
+        updateMemoryPeaks();
     }
 
-void SCMAPD::solve(TimeStep cutOffTime) {
+void SCMAPD::solve(std::chrono::milliseconds cutOffTime) {
+    const auto deadline = std::chrono::steady_clock::now() + cutOffTime;
+
+    // single dispatch on the heuristic, the loop runs on the specialized BigH
+    std::visit([&](auto& specializedBigH){ insertTasks(specializedBigH, deadline, checkpointInterval); }, bigH);
+
+    improve(deadline);
+}
+
+template<typename BigHType>
+void SCMAPD::insertTasks(BigHType &specializedBigH, std::chrono::steady_clock::time_point deadline,
+                         int checkpointInterval) {
     // extractBigHTop takes care of tasks indices removal
-    while( !bigH.empty() ){
-        auto [taskId, pathWrapper] = bigH.extractTop();
-        auto k = pathWrapper.agentId;
+    for(int iteration = 1 ; !specializedBigH.empty() ; ++iteration){
+        profiling::ScopedTimer timer{profiling::Phase::SOLVE_ITERATION};
+        profiling::TraceScope trace{"iteration"};
+
+        // once out of time heaps are not updated anymore
+        if(std::chrono::steady_clock::now() >= deadline){
+            auto [taskId, pathWrapper] = specializedBigH.extractTopDegraded(status);
+            trace.setAgent(pathWrapper.agentId);
+            trace.setTask(taskId);
+            fixTask(taskId, std::move(pathWrapper));
+            degradedTasks.push_back(taskId);
+            continue;
+        }
+
+        auto batch = specializedBigH.extractBatch(status, batchSize);
+        trace.setAgent(batch.front().pathWrapper.agentId);
+        trace.setTask(batch.front().taskId);
+
+        std::vector<FixedTask> fixedTasks;
+        fixedTasks.reserve(batch.size());
+        for(auto& [taskId, pathWrapper] : batch){
+            fixedTasks.push_back({pathWrapper.agentId, taskId});
+            fixTask(taskId, std::move(pathWrapper));
+        }
+
+        specializedBigH.update(fixedTasks, status);
+        updateMemoryPeaks();
+        if(memoryReportInterval > 0 && iteration % memoryReportInterval == 0){
+            fmt::print(stderr, "Iteration {}: status {} bytes, SmallH entries {} bytes, A* search peak {} bytes\n",
+                       iteration, statusPathsMemory.current + statusWaypointsMemory.current, entriesMemory.current,
+                       MultiAStar::getPeakMemoryUsage());
+        }
+
+        if(checkpointInterval > 0 && iteration % checkpointInterval == 0){
+            // only the plans are saved, see saveCheckpoint
+            assert(degradedTasks.empty() && status.getElapsedTime() == 0 && getWaitingAgents().empty());
+            saveCheckpoint(checkpointFile, status, agents, specializedBigH.getTaskIds());
+        }
+    }
+}
+
+void SCMAPD::addTasks(std::vector<Task> &&newTasks, TimeStep releaseTime, std::chrono::milliseconds cutOffTime) {
+    const auto deadline = std::chrono::steady_clock::now() + cutOffTime;
+
+    // late tasks are inserted at the actual time
+    advance(std::max(releaseTime - status.getElapsedTime(), 0));
+
+    std::vector<int> taskIds;
+    taskIds.reserve(newTasks.size());
+    for(const auto& task : newTasks){
+        taskIds.push_back(task.index);
+    }
+    status.addTasks(std::move(newTasks));
+
+    // heap of the new tasks only, SmallH entries extend the actual agent plans
+    std::visit([&](auto& specializedBigH){
+        std::remove_cvref_t<decltype(specializedBigH)> newTasksBigH{
+            getAvailableAgents(), status, taskIds, lazyUpdates, compactEntries, pool
+        };
+        insertTasks(newTasksBigH, deadline);
+    }, bigH);
+
+    // the new paths can open a way to the waiting agents
+    replanWaitingAgents();
+}
+
+bool SCMAPD::cancelTask(int taskId, TimeStep time) {
+    advance(std::max(time - status.getElapsedTime(), 0));
+
+    auto agentId = status.getTaskAgent(taskId);
+    if(!agentId){
+        return false;
+    }
+
+    // goods on board have to be delivered anyway
+    WaypointsList waypoints(
+        waitingWaypoints[*agentId].empty() ? status.getWaypoints(*agentId) : waitingWaypoints[*agentId]
+    );
+    auto isPickup = [taskId](const Waypoint &wp){ return wp.taskIndex == taskId && wp.demand == Demand::PICKUP; };
+    if(std::ranges::none_of(waypoints, isPickup)){
+        return false;
+    }
+    std::erase_if(waypoints, [taskId](const Waypoint &wp){ return wp.taskIndex == taskId; });
+
+    auto tasks = status.getAssignedTasks(*agentId);
+    std::erase(tasks, taskId);
+    status.setAssignedTasks(*agentId, std::move(tasks));
+
+    // a shorter plan frees space, so the other agents are not affected
+    replanAgent(*agentId, std::move(waypoints));
+    return true;
+}
+
+void SCMAPD::stream(std::istream &input, std::chrono::milliseconds cutOffTime) {
+    std::vector<Task> pending;
+    TimeStep pendingReleaseTime = status.getElapsedTime();
+
+    auto flush = [&](){
+        if(pending.empty()){
+            return;
+        }
+        auto nTasks = pending.size();
+
+        auto start = std::chrono::steady_clock::now();
+        addTasks(std::exchange(pending, {}), pendingReleaseTime, cutOffTime);
+        auto latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        fmt::print("batch\ttime {}\ttasks {}\tlatency {:.3f} ms\n", status.getElapsedTime(), nTasks, latency.count());
+    };
+
+    // tasks with the same release time form a batch, an empty line flushes the pending one
+    std::string line;
+    while(std::getline(input, line)){
+        if(line.empty()){
+            flush();
+            continue;
+        }
+
+        if(line.starts_with("cancel")){
+            flush();
+
+            std::stringstream lineStream{line};
+            std::string value;
+            std::getline(lineStream, value, ',');
+            std::getline(lineStream, value, ',');
+            auto taskId = std::stoi(value);
+            std::getline(lineStream, value, ',');
+            auto time = std::stoi(value);
+
+            if(taskId < 0 || taskId >= status.getTasks().size()){
+                throw std::out_of_range(fmt::format("Task {} does not exist", taskId));
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            auto removed = cancelTask(taskId, time);
+            auto latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+            fmt::print("cancel\ttime {}\ttask {}\tremoved {}\tlatency {:.3f} ms\n",
+                       status.getElapsedTime(), taskId, removed, latency.count());
+            continue;
+        }
+
+        auto task = parseTask(line, static_cast<int>(status.getTasks().size() + pending.size()), status.getDistanceMatrix());
+        if(task.releaseTime != pendingReleaseTime){
+            flush();
+            pendingReleaseTime = task.releaseTime;
+        }
+        pending.push_back(std::move(task));
+    }
+    flush();
+}
+
+RepairReport SCMAPD::delayAgent(int agentId, TimeStep delay, TimeStep time) {
+    assert(delay >= 0);
+    advance(std::max(time - status.getElapsedTime(), 0));
+    const auto start = std::chrono::steady_clock::now();
+
+    // the wait is not checked by the planner, the agents running into it are replanned
+    replanAgent(agentId, delay);
+
+    RepairReport report;
+    report.replannedAgents = repairConflicts(agentId);
+    report.waitingAgents = getWaitingAgents();
+    report.latency = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+RepairReport SCMAPD::stopAgent(int agentId, TimeStep time, std::chrono::milliseconds cutOffTime) {
+    advance(std::max(time - status.getElapsedTime(), 0));
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + cutOffTime;
+
+    RepairReport report;
+    const auto& waypoints = waitingWaypoints[agentId].empty() ? status.getWaypoints(agentId) : waitingWaypoints[agentId];
+    for(const auto& wp : waypoints){
+        if(wp.demand == Demand::PICKUP){
+            report.reassignedTasks.push_back(wp.taskIndex);
+        }
+        else if(std::ranges::find(report.reassignedTasks, wp.taskIndex) == report.reassignedTasks.end()){
+            report.lostTasks.push_back(wp.taskIndex);
+        }
+    }
+    waitingWaypoints[agentId].clear();
+
+    // the agent stays where it is forever, as an agent with nothing left to do
+    stoppedAgents[agentId] = true;
+    agentsTTD[agentId] = 0;
+    status.updatePaths({agents[agentId].startPos}, {}, agentId);
+    status.setAssignedTasks(agentId, {});
+
+    report.replannedAgents = repairConflicts(agentId);
+
+    if(!report.reassignedTasks.empty()){
+        std::visit([&](auto& specializedBigH){
+            std::remove_cvref_t<decltype(specializedBigH)> reassignedBigH{
+                getAvailableAgents(), status, report.reassignedTasks, lazyUpdates, compactEntries, pool
+            };
+            insertTasks(reassignedBigH, deadline);
+        }, bigH);
+    }
+
+    report.waitingAgents = getWaitingAgents();
+    report.latency = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+void SCMAPD::replayDisruptions(std::istream &input, std::chrono::milliseconds cutOffTime) {
+    std::string line;
+    while(std::getline(input, line)){
+        if(line.empty()){
+            continue;
+        }
+
+        std::stringstream lineStream{line};
+        std::string value;
+
+        std::getline(lineStream, value, ',');
+        auto time = std::stoi(value);
+        std::getline(lineStream, value, ',');
+        auto agentId = std::stoi(value);
+        std::getline(lineStream, value, ',');
+
+        if(agentId < 0 || agentId >= agents.size()){
+            throw std::out_of_range(fmt::format("Agent {} does not exist", agentId));
+        }
+
+        auto report = value == "stop" ?
+            stopAgent(agentId, time, cutOffTime) :
+            delayAgent(agentId, std::stoi(value), time);
+
+        fmt::print("repair\ttime {}\tagent {}\treplanned {}\treassigned {}\tlost {}\twaiting {}\tlatency {:.3f} ms\n",
+                   status.getElapsedTime(), agentId, report.replannedAgents.size(), report.reassignedTasks.size(),
+                   report.lostTasks.size(), report.waitingAgents.size(), report.latency.count());
+    }
+}
+
+void SCMAPD::execute() {
+    auto hasWaypoints = [this](int k){ return !status.getWaypoints(k).empty(); };
+    const auto agentIds = std::views::iota(0, static_cast<int>(agents.size()));
+
+    while(std::ranges::any_of(agentIds, hasWaypoints)){
+        if(status.getConflictWindow() > 0){
+            advance(replanPeriod);
+            continue;
+        }
+
+        auto longestPath = std::ranges::max(status.getPaths(), {}, &Path::size);
+        advance(static_cast<TimeStep>(longestPath.size()) - 1);
+    }
+}
+
+void SCMAPD::advance(TimeStep dt) {
+    if(dt > 0){
+        placeIdleAgents();
+    }
+    if(status.getConflictWindow() == 0){
+        status.advance(dt, agents);
+        replanWaitingAgents();
+    }
+    while(status.getConflictWindow() > 0 && dt > 0){
+        auto step = std::min(dt, replanPeriod);
+        status.advance(step, agents);
+        dt -= step;
+        repairWindow();
+        replanWaitingAgents();
+    }
+
+    syncAgentsWithStatus();
+}
+
+void SCMAPD::syncAgentsWithStatus() {
+    for(int k = 0 ; k < agents.size() ; ++k){
+        // agents plan from their actual position
+        if(!status.getPaths()[k].empty()){
+            agents[k].startPos = status.getPaths()[k].front();
+        }
+        const auto& waypoints = status.getWaypoints(k);
+        agentsTTD[k] = waypoints.empty() ? 0 : waypoints.back().getCumulatedDelay();
+    }
+}
+
+std::vector<int> SCMAPD::seedStatus(Status &status, const std::vector<AgentInfo> &agents, const SolverOptions &options) {
+    if(!options.resumeFrom.empty()){
+        return loadCheckpoint(options.resumeFrom, agents, status);
+    }
+    if(options.warmStart.empty()){
+        std::vector<int> taskIds;
+        taskIds.reserve(status.getTasks().size());
+        for(const auto& task : status.getTasks()){
+            taskIds.push_back(task.index);
+        }
+        return taskIds;
+    }
+
+    return applyWarmStart(loadWarmStart(options.warmStart), agents, status);
+}
+
+void SCMAPD::repairWindow() {
+    // every replanned path avoids all the others, so after one pass there are no conflicts within the window
+    for(int k = 0 ; k < agents.size() ; ++k){
+        // agents with nothing left to do are avoided by the others
+        if(!status.getWaypoints(k).empty() && status.checkPathWithStatus(status.getPaths()[k], k)){
+            replanAgent(k);
+        }
+    }
+}
+
+void SCMAPD::placeIdleAgents() {
+    std::vector<int> idleAgents;
+    for(int k = 0 ; k < agents.size() ; ++k){
+        if(status.getPaths()[k].empty()){
+            assert(status.getWaypoints(k).empty());
+            status.updatePaths({agents[k].startPos}, {}, k);
+            idleAgents.push_back(k);
+        }
+    }
+    for(int k : idleAgents){
+        repairConflicts(k);
+    }
+}
+
+bool SCMAPD::replanAgent(int agentId, TimeStep startTime) {
+    return replanAgent(agentId, WaypointsList(status.getWaypoints(agentId)), startTime);
+}
+
+bool SCMAPD::replanAgent(int agentId, WaypointsList &&waypoints, TimeStep startTime) {
+    const auto& actualPath = status.getPaths()[agentId];
+    const auto position = actualPath.empty() ? agents[agentId].startPos : actualPath.front();
+    // kept for the next attempt if there is no path
+    WaypointsList pending{waypoints};
+
+    try{
+        MultiAStar pathfinder{};
+        auto [path, newWaypoints] = pathfinder.solve(std::move(waypoints), position, status, agentId, startTime);
 
-        status.updatePaths(std::move(pathWrapper.path), k);
-        bigH.update(k, taskId, status);
+        agentsTTD[agentId] = newWaypoints.empty() ? 0 : newWaypoints.back().getCumulatedDelay();
+        status.updatePaths(std::move(path), std::move(newWaypoints), agentId);
+        waitingWaypoints[agentId].clear();
+        return true;
     }
+    catch(const std::runtime_error&){
+        // path not found, the agent stops where it is and the others avoid it
+        agentsTTD[agentId] = 0;
+        status.updatePaths({position}, {}, agentId);
+        waitingWaypoints[agentId] = std::move(pending);
+        repairConflicts(agentId);
+        return false;
+    }
+}
+
+void SCMAPD::replanWaitingAgents() {
+    for(int k = 0 ; k < agents.size() ; ++k){
+        if(!waitingWaypoints[k].empty()){
+            replanAgent(k, WaypointsList(waitingWaypoints[k]));
+        }
+    }
+}
+
+std::vector<int> SCMAPD::repairConflicts(int agentId) {
+    std::vector<int> replanned;
+
+    // a replanned path avoids all the others, so one pass is enough
+    for(int k : status.getConflictingAgents(agentId)){
+        // agents with nothing left to do cannot run into the others
+        if(!status.getWaypoints(k).empty()){
+            replanAgent(k);
+            replanned.push_back(k);
+        }
+    }
+    return replanned;
+}
+
+std::vector<AgentInfo> SCMAPD::getAvailableAgents() const {
+    std::vector<AgentInfo> available;
+    available.reserve(agents.size());
+    for(const auto& agent : agents){
+        // waiting agents get new tasks once their waypoints are planned again
+        if(!stoppedAgents[agent.index] && waitingWaypoints[agent.index].empty()){
+            available.push_back(agent);
+        }
+    }
+    return available;
+}
+
+void SCMAPD::fixTask(int taskId, PathWrapper &&pathWrapper) {
+    auto k = pathWrapper.agentId;
+
+    agentsTTD[k] = pathWrapper.ttd;
+    status.updatePaths(std::move(pathWrapper.path), std::move(pathWrapper.waypoints), k);
+    status.assignTask(taskId, k);
 }
 
-void SCMAPD::printResult() const{
+void SCMAPD::improve(std::chrono::steady_clock::time_point deadline) {
+    // plans are rebuilt from scratch, so there must be no task already picked up
+    assert(status.getElapsedTime() == 0);
+
+    // most delayed agents first
+    std::vector<int> agentIds(agents.size());
+    std::iota(agentIds.begin(), agentIds.end(), 0);
+    std::ranges::stable_sort(agentIds, std::greater<>{}, [this](int k){ return agentsTTD[k]; });
+
+    for(int k : agentIds){
+        if(std::chrono::steady_clock::now() >= deadline){
+            return;
+        }
+
+        auto tasks = status.getAssignedTasks(k);
+        if(tasks.size() < 2){
+            continue;
+        }
+        std::ranges::stable_sort(tasks, {}, [this](int taskId){ return status.getTask(taskId).idealGoalTime; });
+
+        // own path is ignored by the planner, so the candidate only has to avoid the other agents
+        Assignment candidate{agents[k]};
+        for(int taskId : tasks){
+            candidate.addTask(taskId, status);
+        }
+
+        auto pathWrapper = candidate.extractAndReset();
+        if(pathWrapper.ttd < agentsTTD[k] && !status.checkPathWithStatus(pathWrapper.path, k)){
+            agentsTTD[k] = pathWrapper.ttd;
+            status.updatePaths(std::move(pathWrapper.path), std::move(pathWrapper.waypoints), k);
+        }
+    }
+}
+
+int SCMAPD::optimize(std::chrono::milliseconds budget) {
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+
+    Solution solution{status, agentsTTD};
+    LNS lns{agents, heuristic, lnsNeighborhoodSize, lazyUpdates, pool};
+    auto accepted = lns.run(solution, deadline);
+
+    status = std::move(solution.status);
+    agentsTTD = std::move(solution.agentsTTD);
+
+    return accepted;
+}
+
+void SCMAPD::updateMemoryPeaks() {
+    if(!memoryReport){
+        return;
+    }
+
+    auto memory = std::visit([](const auto& specializedBigH){ return specializedBigH.getMemoryUsage(); }, bigH);
+    entriesMemory.update(memory.entries + memory.waypoints + memory.storedPath);
+    entriesFullPathMemory.update(memory.entries + memory.waypoints + memory.fullPath);
+    statusPathsMemory.update(status.getPathsMemoryUsage());
+    statusWaypointsMemory.update(status.getWaypointsMemoryUsage());
+}
+
+void SCMAPD::printMemoryReport(std::FILE *out) const {
+    // status keeps changing after the last iteration (execution, repairs), so its current usage is measured again
+    auto withCurrent = [](MemoryUsage usage, std::size_t current){
+        usage.update(current);
+        return usage;
+    };
+    const auto dmBytes = status.getDistanceMatrix().getMemoryUsage();
+
+    const std::vector<std::pair<std::string, MemoryUsage>> rows{
+        {"distance matrix", {dmBytes, dmBytes}},
+        {"status paths", withCurrent(statusPathsMemory, status.getPathsMemoryUsage())},
+        {"status waypoints", withCurrent(statusWaypointsMemory, status.getWaypointsMemoryUsage())},
+        {fmt::format("SmallH entries ({} paths)", compactEntries ? "compact" : "full"), entriesMemory},
+        {"SmallH entries (uncompressed paths)", entriesFullPathMemory},
+        // searches are transient, only the largest one is kept
+        {"A* search", {0, MultiAStar::getPeakMemoryUsage()}}
+    };
+
+    fmt::print(out, "{:<36}{:>16}{:>16}\n", "Memory (bytes)", "current", "peak");
+    for(const auto& [name, usage] : rows){
+        fmt::print(out, "{:<36}{:>16}{:>16}\n", name, usage.current, usage.peak);
+    }
+}
+
+void MemoryUsage::update(std::size_t bytes) {
+    current = bytes;
+    peak = std::max(peak, bytes);
+}
+
+std::vector<Path> SCMAPD::getFullPaths() const {
+    std::vector<Path> paths;
+    paths.reserve(status.getPaths().size());
+    for(int i = 0 ; i < status.getPaths().size() ; ++i){
+        auto& path = paths.emplace_back(status.getExecutedPath(i));
+        path.insert(path.end(), status.getPaths()[i].begin(), status.getPaths()[i].end());
+    }
+    return paths;
+}
+
+const WaypointsList &SCMAPD::getWaypoints(int agentId) const {
+    return status.getWaypoints(agentId);
+}
+
+void SCMAPD::printResult(std::FILE *out) const{
     auto buildPathString = [this](const Path& path){
         static constexpr std::string_view pattern = "({},{})->";
 
@@ -43,26 +578,61 @@ void SCMAPD::printResult() const{
         return result;
     };
 
-    fmt::print("agent\tcost\tpath\n");
+    fmt::print(out, "agent\tcost\tpath\n");
+    auto paths = getFullPaths();
+    for(int i = 0 ; i < paths.size() ; ++i){
+        fmt::print(out, "{}\t{}\t{}\n", i, paths[i].size(), buildPathString(paths[i]));
+    }
+
+    fmt::print(out, "agent\twaypoints\n");
     for(int i = 0 ; i < status.getPaths().size() ; ++i){
-        fmt::print("{}\t{}\t{}\n", i, status.getPaths()[i].size(), buildPathString(status.getPaths()[i]));
+        std::vector<std::string> waypoints;
+        for(const auto& wp : status.getWaypoints(i)){
+            auto pos2D = status.getDistanceMatrix().from1Dto2D(wp.position);
+            waypoints.push_back(fmt::format(
+                "{}{}({},{})", wp.demand == Demand::PICKUP ? 'p' : 'd', wp.taskIndex, pos2D.row, pos2D.col
+            ));
+        }
+        fmt::print(out, "{}\t{}\n", i, fmt::join(waypoints, " "));
     }
 }
 
 void SCMAPD::printCheckMessage() const{
-    if(!status.checkAllConflicts()){
+    if(!hasCollisions()){
         fmt::print(fmt::emphasis::bold | fg(fmt::color::green), "No collisions\n");
     }
 }
 
-SCMAPD loadData(const std::filesystem::path &agentsFile, const std::filesystem::path &tasksFile,
-                       const std::filesystem::path &gridFile, const std::filesystem::path &distanceMatrixFile,
-                       Heuristic heuristic) {
-    DistanceMatrix dm{distanceMatrixFile};
-    AmbientMap ambientMap(gridFile, std::move(dm));
+bool SCMAPD::hasCollisions() const {
+    profiling::ScopedTimer timer{profiling::Phase::VALIDATION};
+    // the executed steps are checked too, the plans only within the window as in status
+    const auto window = status.getConflictWindow() > 0 ? status.getElapsedTime() + status.getConflictWindow() : 0;
+    const auto paths = getFullPaths();
+
+    for(int i = 0 ; i < paths.size() ; ++i){
+        for(int j = i + 1 ; j < paths.size() ; ++j){
+            if(Status::checkPathConflicts(paths[i], paths[j], window)){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const std::vector<int> &SCMAPD::getDegradedTasks() const {
+    return degradedTasks;
+}
 
-    auto robots{loadAgents(agentsFile, ambientMap.getDistanceMatrix())};
-    auto tasks{loadTasks(tasksFile, ambientMap.getDistanceMatrix())};
+std::vector<int> SCMAPD::getWaitingAgents() const {
+    std::vector<int> waiting;
+    for(int k = 0 ; k < agents.size() ; ++k){
+        if(!waitingWaypoints[k].empty()){
+            waiting.push_back(k);
+        }
+    }
+    return waiting;
+}
 
-    return {std::move(ambientMap), robots, std::move(tasks), heuristic, false};
+TimeStep SCMAPD::getTotalDelay() const {
+    return std::accumulate(agentsTTD.begin(), agentsTTD.end(), status.getCompletedDelay());
 }
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fmt/core.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Server.hpp"
+#include "Solver.hpp"
+
+namespace {
+    // larger requests are answered with an error and their connection is closed
+    constexpr std::uint32_t maxPayloadSize = 64 << 20;
+
+    class FileDescriptor {
+    public:
+        explicit FileDescriptor(int fd) : fd{fd} {}
+        FileDescriptor(const FileDescriptor&) = delete;
+        FileDescriptor &operator=(const FileDescriptor&) = delete;
+        ~FileDescriptor(){
+            if(fd >= 0){
+                close(fd);
+            }
+        }
+
+        [[nodiscard]] int get() const{
+            return fd;
+        }
+
+    private:
+        int fd;
+    };
+
+    void writeVarint(std::string &out, std::uint64_t value){
+        while(value >= 0x80){
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    struct PayloadReader{
+        const std::string &payload;
+        std::size_t position;
+
+        char byte(){
+            if(position >= payload.size()){
+                throw std::runtime_error("Truncated request");
+            }
+            return payload[position++];
+        }
+
+        std::uint64_t varint(){
+            std::uint64_t value = 0;
+            for(int shift = 0 ; shift < 64 ; shift += 7){
+                auto b = static_cast<unsigned char>(byte());
+                value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+                if(!(b & 0x80)){
+                    return value;
+                }
+            }
+            throw std::runtime_error("Malformed request");
+        }
+
+        // value in [0, bound)
+        int bounded(std::uint64_t bound, std::string_view what){
+            auto value = varint();
+            if(value >= bound){
+                throw std::runtime_error(fmt::format("{} {} out of range", what, value));
+            }
+            return static_cast<int>(value);
+        }
+
+        // number of items that follow, each takes at least one byte
+        std::size_t count(std::string_view what){
+            return bounded(payload.size() - position + 1, what);
+        }
+
+        // checked against the map by solveInstance
+        Coord coord(){
+            auto row = bounded(std::numeric_limits<int>::max(), "row");
+            return {row, bounded(std::numeric_limits<int>::max(), "col")};
+        }
+    };
+
+    std::string errorResponse(std::string_view message){
+        std::string response{'E'};
+        writeVarint(response, message.size());
+        response.append(message);
+        return response;
+    }
+
+    int directionIndex(const Coord &from, const Coord &to){
+        for(int i = 0 ; i < AmbientMap::nDirections ; ++i){
+            if(from + AmbientMap::directionVector[i] == to){
+                return i;
+            }
+        }
+        throw std::logic_error("Path with a jump");
+    }
+
+    // false on end of file or error
+    bool readAll(int fd, char *buffer, std::size_t size){
+        while(size > 0){
+            auto n = read(fd, buffer, size);
+            if(n < 0 && errno == EINTR){
+                continue;
+            }
+            if(n <= 0){
+                return false;
+            }
+            buffer += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const char *buffer, std::size_t size){
+        while(size > 0){
+            // a client that went away must not kill the server with SIGPIPE
+            auto n = send(fd, buffer, size, MSG_NOSIGNAL);
+            if(n < 0 && errno == EINTR){
+                continue;
+            }
+            if(n <= 0){
+                return false;
+            }
+            buffer += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool writeMessage(int fd, const std::string &payload){
+        std::array<char, 4> header{};
+        for(int i = 0 ; i < header.size() ; ++i){
+            header[i] = static_cast<char>((payload.size() >> (8 * i)) & 0xFF);
+        }
+        return writeAll(fd, header.data(), header.size()) && writeAll(fd, payload.data(), payload.size());
+    }
+
+    // true if a server accepts connections on address
+    bool isListening(const sockaddr_un &address){
+        FileDescriptor probe{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        return probe.get() >= 0 &&
+            connect(probe.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    }
+
+    // nearest rank percentile of sorted values
+    double percentile(const std::vector<double> &sorted, double p){
+        if(sorted.empty()){
+            return 0;
+        }
+        auto rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size()) + 0.5);
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+SolverServer::SolverServer(std::shared_ptr<const AmbientMap> ambientMap, const ServerOptions &options) :
+    ambientMap{std::move(ambientMap)},
+    options{options}
+{
+    latencies.reserve(std::max<std::size_t>(options.latencyWindow, 1));
+}
+
+void SolverServer::run(const std::filesystem::path &socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const auto pathString = socketPath.string();
+    if(pathString.size() >= sizeof(address.sun_path)){
+        throw std::runtime_error("Socket path too long: " + pathString);
+    }
+    std::memcpy(address.sun_path, pathString.c_str(), pathString.size() + 1);
+
+    FileDescriptor listener{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if(listener.get() < 0){
+        throw std::runtime_error(fmt::format("Cannot create socket: {}", std::strerror(errno)));
+    }
+    auto bindSocket = [&](){
+        return bind(listener.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    };
+    if(!bindSocket()){
+        // the file of a server that did not exit cleanly is left behind, nobody accepts on it
+        if(errno != EADDRINUSE || isListening(address) || unlink(pathString.c_str()) != 0 || !bindSocket()){
+            throw std::runtime_error(fmt::format("Cannot bind {}: {}", pathString, std::strerror(errno)));
+        }
+    }
+    if(listen(listener.get(), SOMAXCONN) != 0){
+        auto error = errno;
+        unlink(pathString.c_str());
+        throw std::runtime_error(fmt::format("Cannot listen on {}: {}", pathString, std::strerror(error)));
+    }
+
+    std::vector<std::thread> workers;
+    for(int i = 0 ; i < std::max(options.nWorkers, 1) ; ++i){
+        workers.emplace_back(&SolverServer::workerLoop, this);
+    }
+
+    // polled with a timeout, so that stop only has to set the flag
+    while(!stopRequested.load()){
+        pollfd listenerPoll{listener.get(), POLLIN, 0};
+        auto ready = poll(&listenerPoll, 1, 200);
+        if(ready < 0 && errno != EINTR){
+            break;
+        }
+        if(ready <= 0){
+            continue;
+        }
+
+        int connection = accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC);
+        if(connection < 0){
+            continue;
+        }
+        {
+            std::scoped_lock lock{connectionsMutex};
+            pendingConnections.push_back(connection);
+        }
+        connectionsCv.notify_one();
+    }
+
+    {
+        std::scoped_lock lock{connectionsMutex};
+        closing = true;
+        for(auto fd : pendingConnections){
+            close(fd);
+        }
+        pendingConnections.clear();
+        // wakes up the workers blocked on a read, running solves complete first
+        for(auto fd : activeConnections){
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    connectionsCv.notify_all();
+    for(auto& worker : workers){
+        worker.join();
+    }
+    unlink(pathString.c_str());
+}
+
+void SolverServer::stop() {
+    stopRequested.store(true);
+}
+
+void SolverServer::workerLoop() {
+    while(true){
+        int fd;
+        {
+            std::unique_lock lock{connectionsMutex};
+            connectionsCv.wait(lock, [this](){ return closing || !pendingConnections.empty(); });
+            if(closing){
+                return;
+            }
+            fd = pendingConnections.front();
+            pendingConnections.pop_front();
+            activeConnections.insert(fd);
+        }
+
+        serveConnection(fd);
+
+        {
+            std::scoped_lock lock{connectionsMutex};
+            activeConnections.erase(fd);
+        }
+        close(fd);
+    }
+}
+
+void SolverServer::serveConnection(int fd) {
+    if(options.idleTimeout.count() > 0){
+        // a client that stops sending or reading must not hold its worker, reads and writes fail after the timeout
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(options.idleTimeout);
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(options.idleTimeout - seconds);
+        timeval timeout{.tv_sec = seconds.count(), .tv_usec = micros.count()};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+    while(true){
+        std::array<unsigned char, 4> header{};
+        if(!readAll(fd, reinterpret_cast<char*>(header.data()), header.size())){
+            return;
+        }
+        std::uint32_t size = 0;
+        for(int i = 0 ; i < header.size() ; ++i){
+            size |= static_cast<std::uint32_t>(header[i]) << (8 * i);
+        }
+        if(size > maxPayloadSize){
+            writeMessage(fd, errorResponse(fmt::format("Request of {} bytes, the limit is {}", size, maxPayloadSize)));
+            return;
+        }
+
+        std::string request(size, '\0');
+        if(!readAll(fd, request.data(), size)){
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto response = handleRequest(request);
+        const bool sent = writeMessage(fd, response);
+        if(!request.empty() && request.front() == 'S'){
+            recordLatency(std::chrono::steady_clock::now() - start, !sent || response.front() == 'E');
+        }
+        if(!sent){
+            return;
+        }
+    }
+}
+
+std::string SolverServer::handleRequest(const std::string &request) {
+    if(request.empty()){
+        return errorResponse("Empty request");
+    }
+
+    switch(request.front()){
+        case 'S':
+            try{
+                return solve(request);
+            }
+            catch(const std::exception &e){
+                return errorResponse(e.what());
+            }
+        case 'L': {
+            auto json = writeLatencyStats(getLatencyStats());
+            std::string response{'O'};
+            writeVarint(response, json.size());
+            response.append(json);
+            return response;
+        }
+        default:
+            return errorResponse(fmt::format("Unknown request type {}", static_cast<int>(request.front())));
+    }
+}
+
+std::string SolverServer::solve(const std::string &request) {
+    PayloadReader reader{request, 1};
+
+    SolveOptions solveOptions{.solver = options.solver, .cutOffTime = options.cutOffTime};
+    if(auto cutOffTime = reader.bounded(std::numeric_limits<int>::max(), "cutoff") ; cutOffTime > 0){
+        solveOptions.cutOffTime = std::chrono::milliseconds{cutOffTime};
+    }
+
+    std::vector<Coord> agents(reader.count("agents"));
+    for(auto& agent : agents){
+        agent = reader.coord();
+    }
+
+    std::vector<TaskSpec> tasks(reader.count("tasks"));
+    for(auto& task : tasks){
+        task.pickup = reader.coord();
+        task.delivery = reader.coord();
+        task.releaseTime = reader.bounded(std::numeric_limits<TimeStep>::max(), "release time");
+    }
+    if(reader.position != request.size()){
+        throw std::runtime_error("Malformed request");
+    }
+
+    auto result = solveInstance(ambientMap, agents, tasks, solveOptions);
+
+    std::string response{'O'};
+    response.push_back(result.collisions ? 1 : 0);
+    writeVarint(response, result.totalDelay);
+
+    for(int i = 0 ; i < agents.size() ; ++i){
+        const auto& path = result.paths[i];
+        writeVarint(response, path.size());
+        if(!path.empty()){
+            writeVarint(response, path.front().row);
+            writeVarint(response, path.front().col);
+            for(int t = 1 ; t < path.size() ; ++t){
+                response.push_back(static_cast<char>(directionIndex(path[t - 1], path[t])));
+            }
+        }
+
+        const auto& stops = result.stops[i];
+        writeVarint(response, stops.size());
+        for(const auto& stop : stops){
+            writeVarint(response, stop.task);
+            response.push_back(stop.demand == Demand::PICKUP ? 'p' : 'd');
+            writeVarint(response, stop.arrivalTime);
+        }
+    }
+    return response;
+}
+
+void SolverServer::recordLatency(std::chrono::duration<double, std::milli> latency, bool failed) {
+    std::scoped_lock lock{statsMutex};
+    ++nRequests;
+    nErrors += failed;
+    if(latencies.size() < std::max<std::size_t>(options.latencyWindow, 1)){
+        latencies.push_back(latency.count());
+    }
+    else{
+        latencies[nextLatency] = latency.count();
+        nextLatency = (nextLatency + 1) % latencies.size();
+    }
+}
+
+LatencyStats SolverServer::getLatencyStats() const {
+    std::vector<double> sorted;
+    LatencyStats stats;
+    {
+        std::scoped_lock lock{statsMutex};
+        sorted = latencies;
+        stats.requests = nRequests;
+        stats.errors = nErrors;
+    }
+    if(sorted.empty()){
+        return stats;
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+    for(auto l : sorted){
+        stats.mean += l;
+    }
+    stats.mean /= static_cast<double>(sorted.size());
+    stats.p50 = percentile(sorted, 0.5);
+    stats.p90 = percentile(sorted, 0.9);
+    stats.p99 = percentile(sorted, 0.99);
+    stats.max = sorted.back();
+    return stats;
+}
+
+std::string writeLatencyStats(const LatencyStats &stats) {
+    return fmt::format(
+        "{{\"requests\": {}, \"errors\": {}, \"mean_ms\": {:.3f}, \"p50_ms\": {:.3f}, \"p90_ms\": {:.3f}, "
+        "\"p99_ms\": {:.3f}, \"max_ms\": {:.3f}}}",
+        stats.requests, stats.errors, stats.mean, stats.p50, stats.p90, stats.p99, stats.max
+    );
+}
@@ -1,27 +1,28 @@
 #include <algorithm>
 #include "SmallH.hpp"
+#include "Heuristics.hpp"
+#include "Profiling.hpp"
 
-SmallH::SmallH(const std::vector<AgentInfo> &agentsInfos, int taskId, int v, const Status &status) :
+SmallH::SmallH(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status, bool compact) :
         taskId{taskId},
-        v{v},
-        heap{initializeHeap(agentsInfos, taskId, status)},
-        heapHandles{getHandles(heap)}
+        heap{initializeHeap(agentsInfos, taskId, status, compact)}
     {
         #ifndef NDEBUG
-        for(int i = 0 ; i < heapHandles.size() ; ++i){
-            assert((*heapHandles[i]).getAgentId() == i);
+        // ids can have gaps, e.g. stopped agents are left out
+        for(int agentId : heap.ids()){
+            assert(heap[agentId].getAgentId() == agentId);
         }
         #endif
     }
 
-SmallHFibHeap
-SmallH::initializeHeap(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status) {
-    SmallHFibHeap heap{};
+SmallHHeap
+SmallH::initializeHeap(const std::vector<AgentInfo> &agentsInfos, int taskId, const Status &status, bool compact) {
+    SmallHHeap heap{};
 
     for (const auto& aInfo : agentsInfos){
         auto agentIndex = aInfo.index;
-        heap.emplace(aInfo, taskId, status);
-        assert(agentIndex >= 0 && agentIndex < agentsInfos.size());
+        assert(agentIndex >= 0 && agentIndex < status.getPaths().size());
+        heap.emplace(agentIndex, aInfo, taskId, status, compact);
     }
 
     return heap;
@@ -31,57 +32,86 @@ PathWrapper SmallH::extractTopAndReset() {
     assert(!heap.empty());
 
     // atomic block
-    auto topAssignment = std::move(const_cast<Assignment&>(heap.top()));
+    auto pathWrapper = heap[heap.topId()].extractAndReset();
     heap.clear();
 
-    return topAssignment.extractAndReset();
+    return pathWrapper;
 }
 
-void SmallH::updateTopElements(const Path &fixedPath, const Status &status) {
-    // todo check this
-    for (int i = 0 ; i < std::min(v, static_cast<int>(heap.size())) ; ++i) {
-        auto targetIt = std::next(heap.begin(), i);
+PathWrapper SmallH::extractRefreshedTopAndReset(const Status &status) {
+    assert(!heap.empty());
+
+    auto& top = heap[heap.topId()];
+    if(!top.isUpToDate(status)){
+        top.refresh(status);
+    }
+
+    return extractTopAndReset();
+}
+
+template<int V>
+bool SmallH::refreshTopElements(const Status &status) {
+    bool changed = false;
 
-        if(status.checkPathConflicts(fixedPath, targetIt->getPath())){
-            auto& handle = heapHandles[targetIt->getAgentId()];
-            assert((*handle).getAgentId() == targetIt->getAgentId());
+    for(bool restart = true ; restart ; ){
+        restart = false;
 
-            // todo check if it is possible to use increase or decrease
-            // atomic
-            (*handle).internalUpdate(status);
-            heap.update(handle);
+        for(int targetId : heap.topIds<V>()){
+            if(!heap[targetId].isUpToDate(status)){
+                profiling::count(profiling::Counter::REPLANS);
+                // atomic
+                heap[targetId].refresh(status);
+                heap.update(targetId);
 
-            // restart
-            i = 0;
+                // order changed, restart
+                changed = restart = true;
+                break;
+            }
         }
     }
+
+    return changed;
 }
 
+template bool SmallH::refreshTopElements<heuristics::MCA::v>(const Status &status);
+template bool SmallH::refreshTopElements<heuristics::RMCA_A::v>(const Status &status);
+// RMCA_R shares the instantiation of RMCA_A
+static_assert(heuristics::RMCA_R::v == heuristics::RMCA_A::v);
+
 TimeStep SmallH::getTopMCA() const{
     assert(!heap.empty());
     return heap.top().getMCA();
 }
 
+const Assignment &SmallH::getTopAssignment() const {
+    assert(!heap.empty());
+    return heap.top();
+}
+
+TimeStep SmallH::getSecondMCA() const{
+    assert(!heap.empty());
+    auto secondId = heap.secondId();
+    return secondId ? heap[*secondId].getMCA() : getTopMCA();
+}
+
 void SmallH::addTaskToAgent(int k, int otherTaskId, const Status &status) {
-    auto& targetHandle = heapHandles[k];
-    assert((*targetHandle).getAgentId() == k);
+    assert(heap.contains(k) && heap[k].getAgentId() == k);
 
     //atomic
-    (*targetHandle).addTask(otherTaskId, status);
+    heap[k].addFixedTask(otherTaskId, status);
 
     // todo check if can use increase
-    heap.update(targetHandle);
+    heap.update(k);
 }
 
 int SmallH::getTaskId() const {
     return taskId;
 }
 
-SmallHHandles SmallH::getHandles(const SmallHFibHeap& heap){
-    SmallHHandles heapHandles{};
-
-    for(auto it = heap.begin(); it != heap.end() ; ++it){
-        heapHandles.emplace(it->getAgentId(), SmallHFibHeap::s_handle_from_iterator(it));
+AssignmentMemory SmallH::getMemoryUsage() const {
+    AssignmentMemory memory{.entries = heap.getMemoryUsage()};
+    for(int agentId : heap.ids()){
+        memory += heap[agentId].getMemoryUsage();
     }
-    return heapHandles;
+    return memory;
 }
@@ -0,0 +1,126 @@
+#include <stdexcept>
+#include <fmt/core.h>
+#include "Solver.hpp"
+#include "SCMAPD.hpp"
+#include "Profiling.hpp"
+
+namespace {
+    CompressedCoord checkedPosition(const AmbientMap &ambientMap, const Coord &position, std::string_view what, int index){
+        if(!ambientMap.isValid(position)){
+            throw std::invalid_argument(fmt::format(
+                "{} {}: ({},{}) is outside the map or on an obstacle", what, index, position.row, position.col
+            ));
+        }
+        return ambientMap.getDistanceMatrix().from2Dto1D(position);
+    }
+
+    SolveResult collectResult(const SCMAPD &scmapd, const DistanceMatrix &dm){
+        SolveResult result;
+        result.totalDelay = scmapd.getTotalDelay();
+        result.collisions = scmapd.hasCollisions();
+        result.degradedTasks = scmapd.getDegradedTasks();
+        result.waitingAgents = scmapd.getWaitingAgents();
+
+        for(const auto& path : scmapd.getFullPaths()){
+            auto& coords = result.paths.emplace_back();
+            coords.reserve(path.size());
+            for(auto c : path){
+                coords.push_back(dm.from1Dto2D(c));
+            }
+        }
+        for(int i = 0 ; i < result.paths.size() ; ++i){
+            auto& stops = result.stops.emplace_back();
+            for(const auto& wp : scmapd.getWaypoints(i)){
+                stops.push_back({wp.taskIndex, wp.demand, wp.getArrivalTime()});
+            }
+        }
+        return result;
+    }
+
+    // solve, LNS, events and execution, start is when the loading began
+    SolveResult solveLoaded(const std::shared_ptr<const AmbientMap> &ambientMap, const std::vector<AgentInfo> &agents,
+                            std::vector<Task> &&tasks, const SolveOptions &options, const SolveEvents &events,
+                            std::FILE *resultOut, std::chrono::steady_clock::time_point start){
+        SCMAPD scmapd{ambientMap, agents, std::move(tasks), options.solver, false};
+        scmapd.solve(options.cutOffTime);
+        if(options.lnsBudget.count() > 0){
+            scmapd.optimize(options.lnsBudget);
+        }
+        if(events.disruptions){
+            scmapd.replayDisruptions(*events.disruptions, options.cutOffTime);
+        }
+        if(events.stream){
+            scmapd.stream(*events.stream, options.cutOffTime);
+        }
+        // windowed plans are checked only in their first steps, so they are executed with repairs
+        if(options.solver.conflictWindow > 0){
+            scmapd.execute();
+        }
+
+        if(resultOut){
+            scmapd.printResult(resultOut);
+            if(options.solver.memoryReport){
+                scmapd.printMemoryReport(resultOut);
+            }
+        }
+
+        auto result{collectResult(scmapd, ambientMap->getDistanceMatrix())};
+        result.time = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+}
+
+SolveResult solveInstance(const std::shared_ptr<const AmbientMap> &ambientMap, const std::vector<Coord> &agents,
+                          const std::vector<TaskSpec> &tasks, const SolveOptions &options) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto& dm = ambientMap->getDistanceMatrix();
+
+    if(agents.empty()){
+        throw std::invalid_argument("No agents");
+    }
+    std::vector<AgentInfo> agentInfos;
+    agentInfos.reserve(agents.size());
+    for(int i = 0 ; i < agents.size() ; ++i){
+        agentInfos.push_back({checkedPosition(*ambientMap, agents[i], "agent", i), options.agentCapacity, i});
+    }
+
+    std::vector<Task> taskVector;
+    taskVector.reserve(tasks.size());
+    for(int i = 0 ; i < tasks.size() ; ++i){
+        taskVector.emplace_back(
+            checkedPosition(*ambientMap, tasks[i].pickup, "pickup of task", i),
+            checkedPosition(*ambientMap, tasks[i].delivery, "delivery of task", i),
+            tasks[i].releaseTime, i, dm
+        );
+    }
+
+    return solveLoaded(ambientMap, agentInfos, std::move(taskVector), options, {}, nullptr, start);
+}
+
+SolveResult solveFiles(const InstanceFiles &files, const SolveOptions &options, const SolveEvents &events,
+                       std::FILE *resultOut) {
+    const auto start = std::chrono::steady_clock::now();
+
+    profiling::ScopedTimer loadTimer{profiling::Phase::LOAD};
+    auto ambientMap{std::make_shared<const AmbientMap>(files.gridFile, DistanceMatrix{files.distanceMatrixFile})};
+    const auto& dm = ambientMap->getDistanceMatrix();
+    auto agents{loadAgents(files.agentsFile, dm, ',', options.agentCapacity)};
+    auto tasks{loadTasks(files.tasksFile, dm)};
+    loadTimer.stop();
+
+    return solveLoaded(ambientMap, agents, std::move(tasks), options, events, resultOut, start);
+}
+
+SolveResult solveFiles(const std::shared_ptr<const AmbientMap> &ambientMap, const std::filesystem::path &agentsFile,
+                       const std::filesystem::path &tasksFile, const SolveOptions &options,
+                       const SolveEvents &events, std::FILE *resultOut) {
+    const auto start = std::chrono::steady_clock::now();
+
+    profiling::ScopedTimer loadTimer{profiling::Phase::LOAD};
+    const auto& dm = ambientMap->getDistanceMatrix();
+    auto agents{loadAgents(agentsFile, dm, ',', options.agentCapacity)};
+    auto tasks{loadTasks(tasksFile, dm)};
+    loadTimer.stop();
+
+    return solveLoaded(ambientMap, agents, std::move(tasks), options, events, resultOut, start);
+}
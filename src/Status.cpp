@@ -2,35 +2,156 @@
 // Created by nicco on 05/12/2022.
 //
 
+#include <cassert>
 #include <fmt/core.h>
 #include "Status.hpp"
+#include "Profiling.hpp"
 #include "fmt/color.h"
 
 Status::Status(AmbientMap &&ambientMap, int nRobots,
-               std::vector<Task> &&tasks) :
-        ambient(std::move(ambientMap)),
-        tasksVector(std::move(tasks)),
-        paths(nRobots)
+               std::vector<Task> &&tasks, TimeStep conflictWindow) :
+        Status(std::make_shared<const AmbientMap>(std::move(ambientMap)), nRobots, std::move(tasks), conflictWindow)
         {}
 
+Status::Status(std::shared_ptr<const AmbientMap> ambientMap, int nRobots,
+               std::vector<Task> &&tasks, TimeStep conflictWindow) :
+        ambient(std::move(ambientMap)),
+        tasksVector(std::make_shared<const std::vector<Task>>(std::move(tasks))),
+        paths(nRobots),
+        assignedTasks(nRobots),
+        taskAgents(tasksVector->size(), -1),
+        waypoints(nRobots),
+        executedPaths(nRobots),
+        pathsVersion(nRobots, 0),
+        conflictWindow{conflictWindow}
+        {
+            assert(conflictWindow >= 0);
+        }
+
 const Task & Status::getTask(int i) const {
-    return tasksVector[i];
+    return (*tasksVector)[i];
 }
 
 const std::vector<Task> &Status::getTasks() const {
-    return tasksVector;
+    return *tasksVector;
 }
 
-void Status::updatePaths(Path &&path, int agentId) {
+
+void Status::updatePaths(Path &&path, WaypointsList &&newWaypoints, int agentId) {
     paths[agentId] = std::move(path);
+    waypoints[agentId] = std::move(newWaypoints);
+    pathsVersion[agentId] = ++version;
+}
+
+const WaypointsList &Status::getWaypoints(int agentId) const {
+    return waypoints[agentId];
+}
+
+void Status::advance(TimeStep dt, const std::vector<AgentInfo> &agents) {
+    assert(dt >= 0 && agents.size() == paths.size());
+    const auto now = elapsedTime + dt;
+
+    for(int k = 0 ; k < paths.size() ; ++k){
+        auto& path = paths[k];
+
+        // agents with no path never moved, while the plan is executed they wait at their start position as the
+        // agents at the end of their path, so they become obstacles for the next plans
+        if(path.empty() && dt > 0){
+            path.push_back(agents[k].startPos);
+        }
+        if(!path.empty()){
+            auto executedSteps = std::min(dt, static_cast<TimeStep>(path.size()) - 1);
+            executedPaths[k].insert(executedPaths[k].end(), path.begin(), path.begin() + executedSteps);
+            // agents wait at the end of their path
+            executedPaths[k].insert(executedPaths[k].end(), dt - executedSteps, path.back());
+            path.erase(path.begin(), path.begin() + executedSteps);
+        }
+
+        auto& agentWaypoints = waypoints[k];
+        while(!agentWaypoints.empty() && agentWaypoints.front().getArrivalTime() <= now){
+            const auto& wp = agentWaypoints.front();
+            if(wp.demand == Demand::DELIVERY){
+                completedDelay += wp.getArrivalTime() - getTask(wp.taskIndex).idealGoalTime;
+                std::erase(assignedTasks[k], wp.taskIndex);
+                taskAgents[wp.taskIndex] = -1;
+            }
+            agentWaypoints.pop_front();
+        }
+
+        // remaining delays are counted from the actual time
+        TimeStep cumulatedDelay = 0;
+        for(auto& wp : agentWaypoints){
+            cumulatedDelay = wp.update(wp.getArrivalTime(), getTasks(), cumulatedDelay);
+        }
+
+        pathsVersion[k] = ++version;
+    }
+
+    elapsedTime = now;
+}
+
+void Status::addTasks(std::vector<Task> &&newTasks) {
+    // copy on write, snapshots keep the old tasks
+    auto tasks = std::make_shared<std::vector<Task>>(*tasksVector);
+    for(auto& task : newTasks){
+        assert(task.index == tasks->size());
+        tasks->push_back(std::move(task));
+    }
+    tasksVector = std::move(tasks);
+    taskAgents.resize(tasksVector->size(), -1);
+}
+
+TimeStep Status::getElapsedTime() const {
+    return elapsedTime;
+}
+
+TimeStep Status::getCompletedDelay() const {
+    return completedDelay;
+}
+
+const Path &Status::getExecutedPath(int agentId) const {
+    return executedPaths[agentId];
+}
+
+void Status::assignTask(int taskId, int agentId) {
+    assignedTasks[agentId].push_back(taskId);
+    taskAgents[taskId] = agentId;
+}
+
+void Status::setAssignedTasks(int agentId, std::vector<int> &&taskIds) {
+    for(int taskId : assignedTasks[agentId]){
+        taskAgents[taskId] = -1;
+    }
+    assignedTasks[agentId] = std::move(taskIds);
+    for(int taskId : assignedTasks[agentId]){
+        taskAgents[taskId] = agentId;
+    }
+}
+
+std::optional<int> Status::getTaskAgent(int taskId) const {
+    assert(taskId >= 0 && taskId < taskAgents.size());
+    return taskAgents[taskId] >= 0 ? std::optional{taskAgents[taskId]} : std::nullopt;
+}
+
+const std::vector<int> &Status::getAssignedTasks(int agentId) const {
+    return assignedTasks[agentId];
+}
+
+TimeStep Status::getConflictWindow() const {
+    return conflictWindow;
+}
+
+int Status::getVersion() const {
+    return version;
 }
 
 std::vector<CompressedCoord> Status::getValidNeighbors(int agentId, CompressedCoord c, TimeStep t) const {
     std::vector<CompressedCoord> neighbors;
     neighbors.reserve(AmbientMap::nDirections);
+    profiling::count(profiling::Counter::NEIGHBOR_CHECKS, AmbientMap::nDirections);
 
     for(int i = 0 ; i < AmbientMap::nDirections ; ++i){
-        auto result = ambient.movement(c, i);
+        auto result = ambient->movement(c, i);
         if(result.has_value() && !checkDynamicObstacle(agentId, c, result.value(), t)){
             neighbors.push_back(result.value());
         }
@@ -42,14 +163,20 @@ std::vector<CompressedCoord> Status::getValidNeighbors(int agentId, CompressedCo
 bool Status::checkDynamicObstacle(int agentId, CompressedCoord coord1, CompressedCoord coord2, TimeStep t1) const{
     assert(agentId >= 0 && agentId < paths.size());
 
-    auto predicate = [t1, coord1, coord2](const Path& p){
+    // the move to t1 + 1 is checked up to the step at the window, which is executed before the next repair
+    const bool beyondWindow = conflictWindow > 0 && t1 + 1 > conflictWindow;
+
+    auto predicate = [t1, coord1, coord2, beyondWindow, this](const Path& p){
         // if path is empty there are no conflicts
         if(p.empty()){
             return false;
         }
+        // beyond the window only agents that stopped within it are obstacles, they do not move anymore
+        if(beyondWindow && p.size() > conflictWindow + 1){
+            return false;
+        }
         auto t2 = std::min(t1 + 1, static_cast<int>(p.size()-1));
 
-        // todo check this
         bool nodeConflict = coord2 == p[t2];
         bool edgeConflict = t1 < (p.size() - 1) && coord1 == p[t2] && coord2 == p[t1];
 
@@ -65,22 +192,49 @@ const std::vector<Path>& Status::getPaths() const {
 }
 
 const DistanceMatrix& Status::getDistanceMatrix() const{
-    return ambient.getDistanceMatrix();
+    return ambient->getDistanceMatrix();
+}
+
+const AmbientMap &Status::getAmbientMap() const {
+    return *ambient;
 }
 
 bool Status::checkPathWithStatus(const Path &path, int agentId) const{
     return std::ranges::any_of(
         paths.begin(),
         paths.begin() + agentId,
-        [&](const Path& other){return checkPathConflicts(path, other);}
+        [&](const Path& other){return checkPathConflicts(path, other, conflictWindow);}
     ) ||
     std::ranges::any_of(
         paths.begin() + agentId + 1,
         paths.end(),
-        [&](const Path& other){return checkPathConflicts(path, other);}
+        [&](const Path& other){return checkPathConflicts(path, other, conflictWindow);}
     );
 }
 
+bool Status::checkFinalPosition(int agentId, CompressedCoord c, TimeStep t) const {
+    // a path stopping after the window is checked only within it (see checkPathConflicts)
+    if(conflictWindow > 0 && t > conflictWindow){
+        return false;
+    }
+
+    for(int i = 0 ; i < paths.size() ; ++i){
+        if(i != agentId && paths[i].size() > t && std::find(paths[i].begin() + t, paths[i].end(), c) != paths[i].end()){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Status::checkPathWithStatus(const Path &path, int agentId, int sinceVersion) const {
+    for(int i = 0 ; i < paths.size() ; ++i){
+        if(i != agentId && pathsVersion[i] > sinceVersion && checkPathConflicts(path, paths[i], conflictWindow)){
+            return true;
+        }
+    }
+    return false;
+}
+
 bool Status::checkAllConflicts() const {
     for(int i = 0 ; i < paths.size() ; ++i){
         for(int j = i+1 ; j < paths.size() ; ++j){
@@ -92,23 +246,41 @@ bool Status::checkAllConflicts() const {
     return false;
 }
 
+std::vector<int> Status::getConflictingAgents(int agentId) const {
+    std::vector<int> conflicting;
+    for(int i = 0 ; i < paths.size() ; ++i){
+        if(checkPathConflicts(agentId, i)){
+            conflicting.push_back(i);
+        }
+    }
+    return conflicting;
+}
+
 bool Status::checkPathConflicts(int i, int j) const{
     if(i == j){
         return false;
     }
 
-    return checkPathConflicts(paths[i], paths[j]);
+    return checkPathConflicts(paths[i], paths[j], conflictWindow);
 }
 
-bool Status::checkPathConflicts(const Path &pA, const Path &pB) {
+bool Status::checkPathConflicts(const Path &pA, const Path &pB, TimeStep window) {
     if(pA.empty() || pB.empty()){
         return false;
     }
 
-    for(int t = 0 ; t < std::max(pA.size(), pB.size()) ; ++t) {
+    // time steps 0 to window are checked, an agent stopped within them stays there, so it is checked against the
+    // whole other path
+    auto end = static_cast<int>(std::max(pA.size(), pB.size()));
+    if(window > 0 && std::min(pA.size(), pB.size()) > window + 1){
+        end = window + 1;
+    }
+
+    for(int t = 0 ; t < end ; ++t) {
         bool nodeConflict =
                 pA[std::min(t, static_cast<int>(pA.size() - 1))] == pB[std::min(t, static_cast<int>(pB.size() - 1))];
-        bool edgeConflict = t < pA.size() - 1 && t < pB.size() && pA[t] == pB[t + 1] && pA[t + 1] == pB[t];
+        bool edgeConflict = t + 1 < pA.size() && t + 1 < pB.size() && t + 1 < end &&
+                pA[t] == pB[t + 1] && pA[t + 1] == pB[t];
 
         if(nodeConflict || edgeConflict){
             return true;
@@ -117,3 +289,22 @@ bool Status::checkPathConflicts(const Path &pA, const Path &pB) {
     return false;
 }
 
+std::size_t Status::getPathsMemoryUsage() const {
+    std::size_t bytes = (paths.capacity() + executedPaths.capacity()) * sizeof(Path);
+    for(const auto& p : paths){
+        bytes += p.capacity() * sizeof(CompressedCoord);
+    }
+    for(const auto& p : executedPaths){
+        bytes += p.capacity() * sizeof(CompressedCoord);
+    }
+    return bytes;
+}
+
+std::size_t Status::getWaypointsMemoryUsage() const {
+    std::size_t bytes = waypoints.capacity() * sizeof(WaypointsList);
+    for(const auto& w : waypoints){
+        // std::list node: value plus two pointers
+        bytes += w.size() * (sizeof(Waypoint) + 2 * sizeof(void*));
+    }
+    return bytes;
+}
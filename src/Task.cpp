@@ -1,4 +1,5 @@
 #include <fstream>
+#include <stdexcept>
 #include <Task.hpp>
 
 bool operator==(const Task &t1, const Task &t2) {
@@ -21,23 +22,20 @@ Task::operator std::string() const {
     );
 }
 
-Task::Task(CompressedCoord startLoc, CompressedCoord goalLoc, const DistanceMatrix& dm) :
+Task::Task(CompressedCoord startLoc, CompressedCoord goalLoc, TimeStep releaseTime, int index,
+           const DistanceMatrix &dm) :
     startLoc{startLoc},
     goalLoc{goalLoc},
-    releaseTime{},
-    index{generateId()},
+    releaseTime{releaseTime},
+    index{index},
     idealGoalTime{releaseTime + dm.getDistance(startLoc, goalLoc)}
 {}
 
-int Task::generateId() {
-    static int id = 0;
-    auto newId = id;
-    ++id;
-    return newId;
-}
-
 std::vector<Task> loadTasks(const std::filesystem::path &tasksFilePath, const DistanceMatrix &dm, char horizontalSep){
     std::ifstream fs (tasksFilePath, std::ios::in);
+    if(!fs){
+        throw std::runtime_error("Cannot open tasks file " + tasksFilePath.string());
+    }
     std::string line;
 
     // nTasks line
@@ -49,24 +47,33 @@ std::vector<Task> loadTasks(const std::filesystem::path &tasksFilePath, const Di
 
     for (int i = 0 ; i < nTasks ; ++i){
         std::getline(fs, line);
+        tasks.push_back(parseTask(line, i, dm, horizontalSep));
+    }
 
-        std::stringstream taskString{line};
-        std::string value;
+    return tasks;
+}
 
-        std::getline(taskString, value, horizontalSep);
-        int yBegin = std::stoi(value);
+Task parseTask(const std::string &line, int index, const DistanceMatrix &dm, char horizontalSep) {
+    std::stringstream taskString{line};
+    std::string value;
 
-        std::getline(taskString, value, horizontalSep);
-        int xBegin = std::stoi(value);
+    std::getline(taskString, value, horizontalSep);
+    int yBegin = std::stoi(value);
 
-        std::getline(taskString, value, horizontalSep);
-        int yEnd = std::stoi(value);
+    std::getline(taskString, value, horizontalSep);
+    int xBegin = std::stoi(value);
 
-        std::getline(taskString, value, horizontalSep);
-        int xEnd = std::stoi(value);
+    std::getline(taskString, value, horizontalSep);
+    int yEnd = std::stoi(value);
 
-        tasks.emplace_back(dm.from2Dto1D({yBegin, xBegin}), dm.from2Dto1D(yEnd, xEnd), dm);
+    std::getline(taskString, value, horizontalSep);
+    int xEnd = std::stoi(value);
+
+    // optional release time
+    TimeStep releaseTime = 0;
+    if(std::getline(taskString, value, horizontalSep) && !value.empty()){
+        releaseTime = std::stoi(value);
     }
 
-    return tasks;
+    return {dm.from2Dto1D({yBegin, xBegin}), dm.from2Dto1D(yEnd, xEnd), releaseTime, index, dm};
 }
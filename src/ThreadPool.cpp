@@ -0,0 +1,136 @@
+#include <algorithm>
+#include "ThreadPool.hpp"
+#include "Profiling.hpp"
+
+ThreadPool::ThreadPool(int nThreads) :
+    queues(std::max(nThreads, 1))
+    {
+        // queue 0 belongs to the calling thread
+        workers.reserve(queues.size() - 1);
+        for(int i = 1 ; i < queues.size() ; ++i){
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock lock{jobMutex};
+        stop = true;
+    }
+    jobCv.notify_all();
+
+    for(auto& w : workers){
+        w.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(queues.size());
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int)> &body) {
+    if(n <= 0){
+        return;
+    }
+    if(workers.empty() || n == 1){
+        for(int i = 0 ; i < n ; ++i){
+            body(i);
+        }
+        return;
+    }
+
+    // a few chunks per thread, so that stealing can balance uneven A* costs
+    const int nChunks = std::min(n, size() * 4);
+    const int grain = n / nChunks;
+    const int remainder = n % nChunks;
+
+    {
+        std::scoped_lock lock{jobMutex};
+        firstException = nullptr;
+        pendingChunks = nChunks;
+
+        int begin = 0;
+        for(int c = 0 ; c < nChunks ; ++c){
+            int end = begin + grain + (c < remainder ? 1 : 0);
+            auto& q = queues[c % queues.size()];
+            std::scoped_lock qLock{q.mutex};
+            q.chunks.push_back({begin, end, &body});
+            begin = end;
+        }
+        ++generation;
+    }
+    jobCv.notify_all();
+
+    drain(0);
+
+    std::unique_lock lock{jobMutex};
+    doneCv.wait(lock, [this](){ return pendingChunks == 0; });
+
+    if(firstException){
+        std::rethrow_exception(std::exchange(firstException, nullptr));
+    }
+}
+
+void ThreadPool::workerLoop(int queueId) {
+    profiling::attachThread();
+    unsigned seenGeneration = 0;
+
+    while(true){
+        {
+            std::unique_lock lock{jobMutex};
+            jobCv.wait(lock, [&](){ return stop || generation != seenGeneration; });
+            if(stop){
+                return;
+            }
+            seenGeneration = generation;
+        }
+        drain(queueId);
+    }
+}
+
+void ThreadPool::drain(int queueId) {
+    Chunk chunk{};
+    while(popOrSteal(queueId, chunk)){
+        try{
+            for(int i = chunk.begin ; i < chunk.end ; ++i){
+                (*chunk.body)(i);
+            }
+        }
+        catch(...){
+            std::scoped_lock lock{jobMutex};
+            if(!firstException){
+                firstException = std::current_exception();
+            }
+        }
+
+        if(--pendingChunks == 0){
+            // lock needed to not lose the wake up of the waiting caller
+            std::scoped_lock lock{jobMutex};
+            doneCv.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::popOrSteal(int queueId, Chunk &chunk) {
+    {
+        auto& own = queues[queueId];
+        std::scoped_lock lock{own.mutex};
+        if(!own.chunks.empty()){
+            chunk = own.chunks.back();
+            own.chunks.pop_back();
+            return true;
+        }
+    }
+
+    for(int offset = 1 ; offset < queues.size() ; ++offset){
+        auto& victim = queues[(queueId + offset) % queues.size()];
+        std::scoped_lock lock{victim.mutex};
+        if(!victim.chunks.empty()){
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
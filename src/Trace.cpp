@@ -0,0 +1,72 @@
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <fmt/ostream.h>
+#include "Trace.hpp"
+
+namespace profiling {
+
+    namespace {
+        std::mutex traceMutex;
+        std::deque<detail::TraceBuffer> traceBuffers;
+        std::size_t bufferSize = 0;
+        std::chrono::steady_clock::time_point traceStart{};
+
+        double toUs(std::chrono::steady_clock::duration d){
+            return std::chrono::duration<double, std::micro>(d).count();
+        }
+    }
+
+    std::atomic<bool> detail::traceActive{false};
+
+    detail::TraceBuffer &detail::registerTraceThread() {
+        std::scoped_lock lock{traceMutex};
+        auto& buffer = traceBuffers.emplace_back();
+        buffer.threadIndex = static_cast<int>(traceBuffers.size()) - 1;
+        buffer.events.resize(bufferSize);
+        return buffer;
+    }
+
+    void startTrace(std::size_t eventsPerThread) {
+        if constexpr(enabled){
+            std::scoped_lock lock{traceMutex};
+            bufferSize = std::max<std::size_t>(eventsPerThread, 1);
+            traceStart = std::chrono::steady_clock::now();
+            detail::traceActive.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void writeTrace(std::ostream &os) {
+        std::scoped_lock lock{traceMutex};
+
+        fmt::print(os, "{{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool first = true;
+        auto separator = [&first]{ return std::exchange(first, false) ? "" : ",\n"; };
+
+        for(const auto& buffer : traceBuffers){
+            auto nRecorded = buffer.nRecorded.load(std::memory_order_acquire);
+            auto nKept = std::min(nRecorded, buffer.events.size());
+
+            fmt::print(os, "{}{{\"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"name\": \"thread_name\", "
+                           "\"args\": {{\"name\": \"thread {} ({} events dropped)\"}}}}",
+                       separator(), buffer.threadIndex, buffer.threadIndex, nRecorded - nKept);
+
+            // oldest kept event first
+            for(auto i = nRecorded - nKept ; i < nRecorded ; ++i){
+                const auto& e = buffer.events[i % buffer.events.size()];
+                fmt::print(os, "{}{{\"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"name\": \"{}\", \"ts\": {:.3f}, \"dur\": {:.3f}, "
+                               "\"args\": {{",
+                           separator(), buffer.threadIndex, e.name, toUs(e.start - traceStart), toUs(e.duration));
+                if(e.agentId >= 0){
+                    fmt::print(os, "\"agent\": {}{}", e.agentId, e.taskId >= 0 ? ", " : "");
+                }
+                if(e.taskId >= 0){
+                    fmt::print(os, "\"task\": {}", e.taskId);
+                }
+                fmt::print(os, "}}}}");
+            }
+        }
+        fmt::print(os, "\n]}}\n");
+    }
+}
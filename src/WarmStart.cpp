@@ -0,0 +1,159 @@
+#include <fstream>
+#include <regex>
+#include <unordered_set>
+#include <unordered_map>
+#include <stdexcept>
+#include "WarmStart.hpp"
+#include "MAPF/MultiAStar.hpp"
+
+namespace {
+    // tasks of the plan whose waypoints match the actual tasks, each one used by a single plan
+    WaypointsList buildWaypoints(const std::vector<PlannedWaypoint> &plan, const Status &status,
+                                 std::unordered_set<int> &usedTasks){
+        const auto& dm = status.getDistanceMatrix();
+
+        auto isValid = [&](const PlannedWaypoint &wp){
+            if(wp.taskId < 0 || wp.taskId >= status.getTasks().size() || usedTasks.contains(wp.taskId)){
+                return false;
+            }
+            const auto& task = status.getTask(wp.taskId);
+            auto expected = wp.demand == Demand::PICKUP ? task.startLoc : task.goalLoc;
+            return dm.from2Dto1D(wp.position) == expected;
+        };
+
+        // a task is kept only with a single pickup followed by a single delivery
+        std::unordered_map<int, int> nVisits;
+        std::unordered_set<int> invalidTasks;
+        for(const auto& wp : plan){
+            auto visit = nVisits[wp.taskId]++;
+            bool expected = (visit == 0 && wp.demand == Demand::PICKUP) || (visit == 1 && wp.demand == Demand::DELIVERY);
+            if(!expected || !isValid(wp)){
+                invalidTasks.insert(wp.taskId);
+            }
+        }
+
+        std::unordered_set<int> validTasks;
+        for(auto [taskId, visits] : nVisits){
+            if(visits == 2 && !invalidTasks.contains(taskId)){
+                validTasks.insert(taskId);
+            }
+        }
+
+        WaypointsList waypoints;
+        for(const auto& wp : plan){
+            if(validTasks.contains(wp.taskId)){
+                const auto& task = status.getTask(wp.taskId);
+                waypoints.push_back(wp.demand == Demand::PICKUP ? getTaskPickupWaypoint(task) : getTaskDeliveryWaypoint(task));
+            }
+        }
+        usedTasks.insert(validTasks.begin(), validTasks.end());
+
+        return waypoints;
+    }
+
+    bool respectsCapacity(const WaypointsList &waypoints, int capacity){
+        int load = 0;
+        for(const auto& wp : waypoints){
+            load += static_cast<int>(wp.demand);
+            if(load > capacity){
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+WarmStart loadWarmStart(const std::filesystem::path &resultFile) {
+    std::ifstream fs (resultFile, std::ios::in);
+    if(!fs){
+        throw std::runtime_error("Cannot open warm start file " + resultFile.string());
+    }
+
+    static const std::regex rowRegex{R"(^(\d+)\t(.*)$)"};
+    static const std::regex waypointRegex{R"(([pd])(\d+)\((\d+),(\d+)\))"};
+
+    WarmStart warmStart;
+    std::string line;
+    bool inTable = false;
+
+    while(std::getline(fs, line)){
+        if(line == "agent\twaypoints"){
+            inTable = true;
+            continue;
+        }
+
+        if(!inTable){
+            continue;
+        }
+        std::smatch row;
+        if(!std::regex_match(line, row, rowRegex)){
+            break;
+        }
+
+        auto agentId = std::stoi(row[1]);
+        if(agentId >= warmStart.size()){
+            warmStart.resize(agentId + 1);
+        }
+
+        auto tokens = row[2].str();
+        for(std::sregex_iterator it{tokens.begin(), tokens.end(), waypointRegex}, end{} ; it != end ; ++it){
+            const auto& match = *it;
+            warmStart[agentId].push_back({
+                match[1] == "p" ? Demand::PICKUP : Demand::DELIVERY,
+                std::stoi(match[2]),
+                {std::stoi(match[3]), std::stoi(match[4])}
+            });
+        }
+    }
+
+    return warmStart;
+}
+
+std::vector<int> applyWarmStart(const WarmStart &warmStart, const std::vector<AgentInfo> &agents, Status &status) {
+    std::unordered_set<int> usedTasks;
+
+    for(const auto& agent : agents){
+        if(agent.index >= warmStart.size()){
+            continue;
+        }
+
+        auto waypoints = buildWaypoints(warmStart[agent.index], status, usedTasks);
+        if(waypoints.empty() || !respectsCapacity(waypoints, agent.capacity)){
+            continue;
+        }
+
+        std::vector<int> taskIds;
+        for(const auto& wp : waypoints){
+            if(wp.demand == Demand::PICKUP){
+                taskIds.push_back(wp.taskIndex);
+            }
+        }
+
+        // agents are planned one after the other, each one avoiding the previous ones
+        try{
+            MultiAStar pathfinder{};
+            auto [path, plannedWaypoints] = pathfinder.solve(std::move(waypoints), agent.startPos, status, agent.index);
+            status.updatePaths(std::move(path), std::move(plannedWaypoints), agent.index);
+            status.setAssignedTasks(agent.index, std::move(taskIds));
+        }
+        catch(const std::runtime_error&){
+            continue;
+        }
+    }
+
+    // a later plan can run into an agent stopped at the end of an earlier one
+    for(const auto& agent : agents){
+        if(!status.getConflictingAgents(agent.index).empty()){
+            status.updatePaths({}, {}, agent.index);
+            status.setAssignedTasks(agent.index, {});
+        }
+    }
+
+    std::vector<int> pendingTasks;
+    for(const auto& task : status.getTasks()){
+        if(!status.getTaskAgent(task.index)){
+            pendingTasks.push_back(task.index);
+        }
+    }
+    return pendingTasks;
+}
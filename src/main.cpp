@@ -1,8 +1,15 @@
 #include <boost/program_options.hpp>
 #include <string>
 #include <iostream>
-#include "SCMAPD.hpp"
-#include "utils.hpp"
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <fmt/color.h>
+#include <fmt/ranges.h>
+#include "CommandLine.hpp"
+#include "Solver.hpp"
+#include "Profiling.hpp"
+#include "Trace.hpp"
 
 int main(int argc, char* argv[]){
     namespace po = boost::program_options;
@@ -18,7 +25,35 @@ int main(int argc, char* argv[]){
         ("dm", po::value<string>()->required(), "distance matrix file")
         ("a", po::value<string>()->required(), "agents file")
         ("t", po::value<string>()->required(), "tasks file")
+
+        // solver settings
+        ("cutoff", po::value<double>()->default_value(10.), "solver time budget in seconds")
+        ("lns", po::value<double>()->default_value(0.), "time budget in seconds of the LNS improvement phase, 0 to skip it")
+        ("lns-size", po::value<int>()->default_value(10), "number of tasks reinserted by every LNS move")
+        ("stream", po::value<string>(),
+            "after solving, read tasks with release time (yStart,xStart,yGoal,xGoal,release) and cancellations "
+            "(cancel,taskId,time) from file or - for stdin")
+        ("disruptions", po::value<string>(),
+            "after solving, read agent delays (time,agent,steps) and breakdowns (time,agent,stop) from file and repair the plan")
+        ("warm-start", po::value<string>(),
+            "output of a previous run, its plans are kept for the tasks and agents that are still valid")
+        ("checkpoint", po::value<string>(), "file where the state of the greedy insertion is saved periodically")
+        ("checkpoint-every", po::value<int>()->default_value(100),
+            "iterations of the greedy insertion between two checkpoints")
+        ("resume", po::value<string>(), "checkpoint of a preempted run on the same instance, the insertion resumes from it")
+        ("memory-report", po::bool_switch()->default_value(false),
+            "print current and peak memory of distance matrix, status, heap entries and A* searches")
+        ("memory-every", po::value<int>()->default_value(0),
+            "also print the memory in use every N iterations of the greedy insertion (0 to disable)")
+        ("profile", po::value<string>(),
+            "write phase times and solver counters as JSON to file or - for stdout (needs -DCMAPD_PROFILING=ON)")
+        ("trace", po::value<string>(),
+            "write a Chrome trace event file of iterations, heap updates and A* calls (needs -DCMAPD_PROFILING=ON)")
+        ("perf-counters", po::bool_switch()->default_value(false),
+            "add cycles, instructions, cache misses and branch misses of every phase to the profile")
+        ("trace-buffer", po::value<int>()->default_value(1 << 16), "events kept for each thread, the oldest are dropped")
     ;
+    desc.add(solverOptionsDescription(static_cast<int>(std::thread::hardware_concurrency())));
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
 
@@ -35,11 +70,112 @@ int main(int argc, char* argv[]){
     auto robotsFile{vm["a"].as<string>()};
     auto tasksFile{vm["t"].as<string>()};
 
-    SCMAPD scmapd{loadData(robotsFile, tasksFile, gridFile, distanceMatrixFile, Heuristic::MCA)};
-    scmapd.solve(10);
-    scmapd.printResult();
+    auto checkpointInterval{vm["checkpoint-every"].as<int>()};
+    if(checkpointInterval <= 0){
+        throw po::validation_error(
+            po::validation_error::invalid_option_value, "checkpoint-every", std::to_string(checkpointInterval)
+        );
+    }
+    if(vm.count("resume") && vm.count("warm-start")){
+        throw po::error("options 'resume' and 'warm-start' cannot be used together");
+    }
+    if(vm.count("profile") && !profiling::enabled){
+        throw po::error("option 'profile' needs a build configured with -DCMAPD_PROFILING=ON");
+    }
+    if(vm.count("trace") && !profiling::enabled){
+        throw po::error("option 'trace' needs a build configured with -DCMAPD_PROFILING=ON");
+    }
+    if(vm["perf-counters"].as<bool>() && !vm.count("profile")){
+        throw po::error("option 'perf-counters' needs option 'profile'");
+    }
+    auto traceBuffer{vm["trace-buffer"].as<int>()};
+    if(traceBuffer <= 0){
+        throw po::validation_error(po::validation_error::invalid_option_value, "trace-buffer", std::to_string(traceBuffer));
+    }
+    if(vm.count("trace")){
+        profiling::startTrace(traceBuffer);
+    }
+    // before loading, so that the pool threads started by the solver are counted too
+    if(vm["perf-counters"].as<bool>()){
+        if(auto error = profiling::startHardwareCounters() ; !error.empty()){
+            fmt::print(stderr, "Hardware counters not available: {}\n", error);
+        }
+    }
+
+    auto memoryReportInterval{vm["memory-every"].as<int>()};
+    if(memoryReportInterval < 0){
+        throw po::validation_error(
+            po::validation_error::invalid_option_value, "memory-every", std::to_string(memoryReportInterval)
+        );
+    }
+
+    auto options{parseSolverOptions(vm)};
+    options.memoryReport = vm["memory-report"].as<bool>() || memoryReportInterval > 0;
+    options.memoryReportInterval = memoryReportInterval;
+    options.lnsNeighborhoodSize = vm["lns-size"].as<int>();
+    options.warmStart = vm.count("warm-start") ? vm["warm-start"].as<string>() : string{};
+    options.resumeFrom = vm.count("resume") ? vm["resume"].as<string>() : string{};
+    options.checkpointFile = vm.count("checkpoint") ? vm["checkpoint"].as<string>() : string{};
+    options.checkpointInterval = checkpointInterval;
+
+    SolveOptions solveOptions{
+        .solver = options,
+        .cutOffTime = std::chrono::milliseconds{static_cast<long>(vm["cutoff"].as<double>() * 1000)},
+        .lnsBudget = std::chrono::milliseconds{static_cast<long>(vm["lns"].as<double>() * 1000)}
+    };
+
+    SolveEvents events;
+    std::ifstream disruptionsFs{};
+    if(vm.count("disruptions")){
+        disruptionsFs.open(vm["disruptions"].as<string>());
+        events.disruptions = &disruptionsFs;
+    }
+    std::ifstream streamFs{};
+    if(vm.count("stream")){
+        auto streamFile{vm["stream"].as<string>()};
+        if(streamFile != "-"){
+            streamFs.open(streamFile);
+        }
+        events.stream = streamFile == "-" ? &std::cin : &streamFs;
+    }
+
+    SolveResult result;
+    try{
+        result = solveFiles({gridFile, distanceMatrixFile, robotsFile, tasksFile}, solveOptions, events, stdout);
+    }
+    catch(const std::exception &e){
+        // e.g. a truncated checkpoint or one of another instance
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+
+    if(!result.collisions){
+        fmt::print(fmt::emphasis::bold | fg(fmt::color::green), "No collisions\n");
+    }
+    fmt::print("Total delay: {}\n", result.totalDelay);
+
+    if(!result.degradedTasks.empty()){
+        fmt::print("Degraded tasks: {}\n", fmt::join(result.degradedTasks, ","));
+    }
+    if(!result.waitingAgents.empty()){
+        fmt::print("Waiting agents: {}\n", fmt::join(result.waitingAgents, ","));
+    }
 
-    scmapd.printCheckMessage();
+    if(vm.count("profile")){
+        auto profileFile{vm["profile"].as<string>()};
+        if(profileFile == "-"){
+            profiling::writeReport(std::cout);
+        }
+        else{
+            std::ofstream profileFs{profileFile};
+            profiling::writeReport(profileFs);
+        }
+    }
+
+    if(vm.count("trace")){
+        std::ofstream traceFs{vm["trace"].as<string>()};
+        profiling::writeTrace(traceFs);
+    }
 
     return 0;
 }
\ No newline at end of file
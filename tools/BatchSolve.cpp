@@ -0,0 +1,80 @@
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <fmt/core.h>
+#include "Batch.hpp"
+#include "CommandLine.hpp"
+
+int main(int argc, char* argv[]){
+    namespace po = boost::program_options;
+    using std::string;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+
+        // shared map and instances
+        ("m", po::value<string>()->required(), "input file for map")
+        ("dm", po::value<string>()->required(), "distance matrix file")
+        ("manifest", po::value<string>()->required(),
+            "instances to solve, one per line as agentsFile tasksFile [resultFile] (relative to the manifest)")
+        ("out", po::value<string>()->default_value("."), "directory of the result files")
+        ("jobs", po::value<int>()->default_value(static_cast<int>(std::thread::hardware_concurrency())),
+            "number of instances solved at the same time")
+
+        // solver settings, the same for every instance
+        ("cutoff", po::value<double>()->default_value(10.), "solver time budget in seconds of every instance")
+        ("lns", po::value<double>()->default_value(0.), "time budget in seconds of the LNS improvement phase, 0 to skip it")
+        ("lns-size", po::value<int>()->default_value(10), "number of tasks reinserted by every LNS move")
+    ;
+    // the instances are already solved in parallel
+    desc.add(solverOptionsDescription(1));
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    po::notify(vm);
+
+    auto solverOptions{parseSolverOptions(vm)};
+    solverOptions.lnsNeighborhoodSize = vm["lns-size"].as<int>();
+
+    const std::filesystem::path resultDir{vm["out"].as<string>()};
+    std::filesystem::create_directories(resultDir);
+    auto instances = loadManifest(vm["manifest"].as<string>(), resultDir);
+
+    BatchOptions options{
+        .solve = {
+            .solver = solverOptions,
+            .cutOffTime = std::chrono::milliseconds{static_cast<long>(vm["cutoff"].as<double>() * 1000)},
+            .lnsBudget = std::chrono::milliseconds{static_cast<long>(vm["lns"].as<double>() * 1000)}
+        },
+        .nJobs = vm["jobs"].as<int>()
+    };
+
+    // loaded once for all the instances
+    auto ambientMap = std::make_shared<const AmbientMap>(vm["m"].as<string>(), DistanceMatrix{vm["dm"].as<string>()});
+
+    auto results = solveBatch(ambientMap, instances, options);
+
+    int nSolved = 0;
+    fmt::print("result\tdelay\ttime_ms\tstatus\n");
+    for(int i = 0 ; i < instances.size() ; ++i){
+        const auto& r = results[i];
+        if(r.solved){
+            ++nSolved;
+            fmt::print("{}\t{}\t{:.1f}\t{}\n", instances[i].resultFile.string(), r.totalDelay, r.time.count(),
+                       r.collisions ? "collisions" : "ok");
+        }
+        else{
+            fmt::print("{}\t-\t-\terror: {}\n", instances[i].resultFile.string(), r.error);
+        }
+    }
+    fmt::print("Solved {} of {} instances\n", nSolved, instances.size());
+
+    return nSolved == instances.size() ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <fmt/core.h>
+#include "InstanceGenerator.hpp"
+
+int main(int argc, char* argv[]){
+    namespace po = boost::program_options;
+    using std::string;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("out", po::value<string>()->required(),
+            "output prefix, writes <out>.grid.txt, <out>.dm.npy, <out>.agents and <out>.tasks")
+        ("grid", po::value<string>(), "use an existing grid instead of generating a warehouse")
+
+        // warehouse layout
+        ("block-rows", po::value<int>()->default_value(5), "rows of shelf blocks")
+        ("block-cols", po::value<int>()->default_value(2), "columns of shelf blocks")
+        ("shelf-length", po::value<int>()->default_value(16), "shelf cells of each block")
+        ("aisle-width", po::value<int>()->default_value(1), "cells between two blocks")
+
+        // agents and tasks
+        ("agents", po::value<int>()->default_value(10), "number of agents, placed on the endpoints not used by tasks")
+        ("tasks", po::value<int>()->default_value(50), "number of tasks, each endpoint is used by a single task")
+        ("skew", po::value<double>()->default_value(0.),
+            "pickups are concentrated near the top left corner (Zipf exponent on the distance rank, 0 for uniform)")
+        ("horizon", po::value<int>()->default_value(0),
+            "release times uniform in [0, horizon), 0 to release all the tasks at the beginning")
+        ("seed", po::value<unsigned>()->default_value(42), "random seed")
+        ("no-dm", po::bool_switch()->default_value(false), "do not compute the distance matrix")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    po::notify(vm);
+
+    const string out{vm["out"].as<string>()};
+
+    auto grid = vm.count("grid") ?
+        generator::loadGrid(vm["grid"].as<string>()) :
+        generator::warehouseGrid({
+            .nBlockRows = vm["block-rows"].as<int>(),
+            .nBlockCols = vm["block-cols"].as<int>(),
+            .shelfLength = vm["shelf-length"].as<int>(),
+            .aisleWidth = vm["aisle-width"].as<int>()
+        });
+
+    // agents and tasks have separate generators, so that changing the number of agents keeps the same tasks
+    std::mt19937 agentsGen{vm["seed"].as<unsigned>()};
+    std::mt19937 tasksGen{vm["seed"].as<unsigned>() + 1};
+    auto tasks = generator::randomTasks(
+        grid, vm["tasks"].as<int>(), vm["skew"].as<double>(), vm["horizon"].as<int>(), tasksGen
+    );
+    auto agents = generator::randomAgents(grid, vm["agents"].as<int>(), tasks, agentsGen);
+
+    generator::saveGrid(out + ".grid.txt", grid);
+    generator::saveAgents(out + ".agents", agents);
+    generator::saveTasks(out + ".tasks", tasks);
+    if(!vm["no-dm"].as<bool>()){
+        generator::saveDistanceMatrix(out + ".dm.npy", grid);
+    }
+
+    fmt::print("{}x{} grid, {} agents, {} tasks\n", grid.size(), grid.front().size(), agents.size(), tasks.size());
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <boost/program_options.hpp>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <fmt/core.h>
+#include "CommandLine.hpp"
+#include "Server.hpp"
+
+namespace {
+    SolverServer *runningServer = nullptr;
+
+    void stopServer(int){
+        if(runningServer){
+            runningServer->stop();
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    namespace po = boost::program_options;
+    using std::string;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+
+        // map loaded once
+        ("m", po::value<string>()->required(), "input file for map")
+        ("dm", po::value<string>()->required(), "distance matrix file")
+        ("socket", po::value<string>()->required(), "path of the Unix domain socket to listen on")
+        ("workers", po::value<int>()->default_value(static_cast<int>(std::thread::hardware_concurrency())),
+            "number of connections served at the same time")
+        ("latency-window", po::value<int>()->default_value(10000),
+            "number of the last solve requests the latency statistics are computed on")
+        ("idle-timeout", po::value<double>()->default_value(60.),
+            "seconds a client can stay without sending or reading before its connection is closed, 0 to never close it")
+
+        // solver settings, the same for every request
+        ("cutoff", po::value<double>()->default_value(1.), "solver time budget in seconds of the requests without one")
+    ;
+    // the requests are already served in parallel
+    desc.add(solverOptionsDescription(1));
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << '\n';
+        return 1;
+    }
+
+    po::notify(vm);
+
+    auto latencyWindow{vm["latency-window"].as<int>()};
+    if(latencyWindow < 1){
+        throw po::validation_error(po::validation_error::invalid_option_value, "latency-window", std::to_string(latencyWindow));
+    }
+
+    auto idleTimeout{vm["idle-timeout"].as<double>()};
+    if(idleTimeout < 0){
+        throw po::validation_error(po::validation_error::invalid_option_value, "idle-timeout", std::to_string(idleTimeout));
+    }
+
+    ServerOptions options{
+        .solver = parseSolverOptions(vm),
+        .cutOffTime = std::chrono::milliseconds{static_cast<long>(vm["cutoff"].as<double>() * 1000)},
+        .nWorkers = vm["workers"].as<int>(),
+        .idleTimeout = std::chrono::milliseconds{static_cast<long>(idleTimeout * 1000)},
+        .latencyWindow = static_cast<std::size_t>(latencyWindow)
+    };
+
+    SolverServer server{
+        std::make_shared<const AmbientMap>(vm["m"].as<string>(), DistanceMatrix{vm["dm"].as<string>()}), options
+    };
+
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+
+    server.run(vm["socket"].as<string>());
+
+    fmt::print("{}\n", writeLatencyStats(server.getLatencyStats()));
+    return 0;
+}